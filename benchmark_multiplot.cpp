@@ -0,0 +1,395 @@
+// benchmark of multiplot, with the scenarios of the demos in multiplot.h, but without sleeps
+// and at 1e3 to 1e8 points. writes the results as json to stdout (or to the file given
+// with --json), the progress goes to stderr. see make.sh for how to compile it.
+//
+//	benchmark_multiplot [--max-points 1e7] [--frames 50] [--seconds 10] [--only scroll] [--json results.json]
+//
+// for each scenario and number of points it reports:
+//	ingest_points_per_s	points per second that go into the plot (plot() calls or bulk plotting)
+//	frame_ms			percentiles of the time of a redraw() after a small change
+//	peak_rss_mb			peak memory of the process during the case (linux, windows)
+//
+// runs headless (egl) by default. compile with -DMULTIPLOT_SOFTWARE to measure the
+// software rasterizer, or with -DMULTIPLOT_FLTK to draw into a window.
+
+#if !defined(MULTIPLOT_SOFTWARE) && !defined(MULTIPLOT_FLTK) && !defined(_WIN32)
+#define MULTIPLOT_HEADLESS
+#endif
+#include "multiplot.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+using namespace multiplot;
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds_since(Clock::time_point t0) { return std::chrono::duration<double>(Clock::now() - t0).count(); }
+
+// cheap test signal, so the benchmark measures multiplot and not sinf()
+static float signal(size_t i)
+{
+	static std::vector<float> table;
+	if (table.empty()) { for (int k = 0; k < 4096; k++) { table.push_back(sinf(6.2831853f * k / 4096.0f)); } }
+	return table[i & 4095] + 0.25f * table[(7 * i) & 4095];
+}
+
+// the peak memory can only be reset under linux (since 4.0). elsewhere it is the peak of the whole run
+static void reset_peak_memory()
+{
+	#ifdef __linux__
+	if (FILE* f = fopen("/proc/self/clear_refs", "w")) { fputs("5", f); fclose(f); }
+	#endif
+}
+
+static double peak_memory_mb()
+{
+	#ifdef __linux__
+	if (FILE* f = fopen("/proc/self/status", "r"))
+	{
+		char line[256];
+		double kb = 0;
+		while (fgets(line, sizeof(line), f)) { if (0 == strncmp(line, "VmHWM:", 6)) { kb = atof(line + 6); } }
+		fclose(f);
+		return kb / 1024.0;
+	}
+	return 0;
+	#elif defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) { return counters.PeakWorkingSetSize / (1024.0 * 1024.0); }
+	return 0;
+	#else
+	return 0;
+	#endif
+}
+
+static double percentile(std::vector<double> v, double p)
+{
+	if (v.empty()) { return 0; }
+	std::sort(v.begin(), v.end());
+	return v[std::min(v.size() - 1, size_t(p / 100.0 * (v.size() - 1) + 0.5))];
+}
+
+struct Settings
+{
+	size_t max_points = 10000000;
+	int frames = 50;
+	double seconds = 10;	// time limit for the frames of one case
+	std::string only;
+	std::string json;
+	int width = 800, height = 600;
+};
+
+struct Result
+{
+	std::string scenario;
+	size_t points = 0;
+	double ingest_s = 0;
+	size_t ingested = 0;
+	std::vector<double> frame_ms;
+	double peak_rss_mb = 0;
+	std::string note;
+};
+
+// draws a frame and waits until it is done
+static void frame(Multiplot& m)
+{
+	m.redraw();
+	m.check();
+}
+
+// draws the frames of all windows
+static void frame(std::vector<Multiplot*>& m, bool window_manager)
+{
+	if (window_manager) { Window_manager::instance().check(); return; }
+	for (Multiplot* w : m) { frame(*w); }
+}
+
+/**
+*	a scenario fills one or more windows with n points (ingest) and then
+*	changes them a little before each measured frame (update).
+*/
+struct Scenario
+{
+	const char* name;
+	int windows;
+	std::function<size_t(std::vector<Multiplot*>&, size_t n)> ingest;	// returns the number of points plotted
+	std::function<void(std::vector<Multiplot*>&, size_t n, int f)> update;
+	bool window_manager = false;	// frames are drawn by Window_manager::check() instead of each window
+};
+
+static std::vector<Scenario> scenarios()
+{
+	std::vector<Scenario> s;
+
+	// demo1, demo5: a growing trace, point by point
+	s.push_back({ "append", 1,
+		[](std::vector<Multiplot*>& m, size_t n) { for (size_t i = 0; i < n; i++) { m[0]->plot(float(i), signal(i)); } return n; },
+		[](std::vector<Multiplot*>& m, size_t n, int f) { m[0]->plot(float(n + f), signal(n + f)); } });
+
+	// the same with bulk plotting
+	s.push_back({ "append_bulk", 1,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			std::vector<float> x(65536), y(65536);
+			for (size_t i = 0; i < n; i += y.size())
+			{
+				const size_t count = std::min(y.size(), n - i);
+				for (size_t k = 0; k < count; k++) { x[k] = float(i + k); y[k] = signal(i + k); }
+				m[0]->plot(x.data(), y.data(), count);
+			}
+			return n;
+		},
+		[](std::vector<Multiplot*>& m, size_t n, int f) { m[0]->plot(float(n + f), signal(n + f)); } });
+
+	// the same with compressed history (see Trace::compression()), compare peak_rss_mb
+	s.push_back({ "compressed", 1,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			m[0]->compression();
+			std::vector<float> x(65536), y(65536);
+			for (size_t i = 0; i < n; i += y.size())
+			{
+				const size_t count = std::min(y.size(), n - i);
+				for (size_t k = 0; k < count; k++) { x[k] = float(i + k); y[k] = signal(i + k); }
+				m[0]->plot(x.data(), y.data(), count);
+			}
+			return n;
+		},
+		[](std::vector<Multiplot*>& m, size_t n, int f) { m[0]->plot(float(n + f), signal(n + f)); } });
+
+	// the same zoomed into the newest 1000 points, following them (the frame should not depend on n)
+	s.push_back({ "zoomed", 1,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			std::vector<float> x(65536), y(65536);
+			for (size_t i = 0; i < n; i += y.size())
+			{
+				const size_t count = std::min(y.size(), n - i);
+				for (size_t k = 0; k < count; k++) { x[k] = float(i + k); y[k] = signal(i + k); }
+				m[0]->plot(x.data(), y.data(), count);
+			}
+			return n;
+		},
+		[](std::vector<Multiplot*>& m, size_t n, int f)
+		{
+			m[0]->plot(float(n + f), signal(n + f));
+			m[0]->scaling(MP_FIXED_SCALE, double(n + f) - 1000.0, double(n + f), -2.0, 2.0);
+		} });
+
+	// demo2: two scrolling traces (ringbuffers of n points), written twice around
+	s.push_back({ "scroll", 1,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			m[0]->grid(MP_LINEAR_GRID, MP_LINEAR_GRID);
+			(*m[0])[0].scrolling(MP_SCROLL_LEFT, int(n));
+			(*m[0])[1].scrolling(MP_SCROLL_LEFT, int(n));
+			(*m[0])[1].color3f(1, 0, 0);
+			for (size_t i = 0; i < 2 * n; i++)
+			{
+				(*m[0])[0].plot(float(i), signal(i));
+				(*m[0])[1].plot(float(i), signal(3 * i));
+			}
+			return 4 * n;
+		},
+		[](std::vector<Multiplot*>& m, size_t n, int f)
+		{
+			(*m[0])[0].plot(float(2 * n + f), signal(f));
+			(*m[0])[1].plot(float(2 * n + f), signal(3 * f));
+		} });
+
+	// demo10: warp mode with a color per point
+	s.push_back({ "warp", 1,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			m[0]->scaling(MP_FIXED_SCALE, 0.0f, float(n), -2.0f, 2.0f);
+			m[0]->scrolling(MP_SCROLL_WARP, int(n));
+			for (size_t i = 0; i < n + n / 2; i++)
+			{
+				m[0]->color3f(fabsf(signal(i)), fabsf(signal(i + 1000)), fabsf(signal(i + 2000)));
+				m[0]->plot(float(i % n), signal(i));
+			}
+			return n + n / 2;
+		},
+		[](std::vector<Multiplot*>& m, size_t n, int f) { m[0]->plot(float((n + n / 2 + f) % n), signal(f)); } });
+
+	// demo3, demo4: points only, with a size and color per point
+	s.push_back({ "scatter", 1,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			m[0]->linewidth(0);
+			for (size_t i = 0; i < n; i++)
+			{
+				const float g = 0.5f + 0.5f * signal(5 * i);
+				m[0]->color3f(1, g, 1 - g);
+				m[0]->pointsize(1 + 5 * g);
+				m[0]->plot(signal(i), signal(i * 13 + 1024));
+			}
+			return n;
+		},
+		[](std::vector<Multiplot*>& m, size_t, int f) { m[0]->plot(signal(f), signal(f + 1024)); } });
+
+	// demo12: the same drawn as a density map
+	s.push_back({ "density", 1,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			m[0]->density();
+			for (size_t i = 0; i < n; i++) { m[0]->plot(signal(i), signal(i * 13 + 1024)); }
+			return n;
+		},
+		[](std::vector<Multiplot*>& m, size_t, int f) { m[0]->plot(signal(f), signal(f + 1024)); } });
+
+	// demo7: the whole trace is replaced every frame
+	s.push_back({ "lissajous", 1,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			m[0]->scaling(MP_FIXED_SCALE, -1.5f, 1.5f, -1.5f, 1.5f);
+			m[0]->linewidth(2);
+			m[0]->color3f(0, 1, 1);
+			std::vector<float> vx(n), vy(n);
+			for (size_t i = 0; i < n; i++) { vx[i] = signal(i); vy[i] = signal(3 * i + 1024); }
+			m[0]->plot(vx, vy);
+			return n;
+		},
+		[](std::vector<Multiplot*>& m, size_t n, int f)
+		{
+			std::vector<float> vx(n), vy(n);
+			for (size_t i = 0; i < n; i++) { vx[i] = signal(i); vy[i] = signal((3 + f % 3) * i + 1024); }
+			m[0]->clear(0);
+			m[0]->plot(vx, vy);
+		} });
+
+	// demo9: two windows
+	s.push_back({ "multi_window", 2,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			for (size_t i = 0; i < n; i++) { m[0]->plot(float(i), signal(i)); m[1]->plot(float(i), signal(i + 1024)); }
+			return 2 * n;
+		},
+		[](std::vector<Multiplot*>& m, size_t n, int f) { m[0]->plot(float(n + f), signal(f)); m[1]->plot(float(n + f), signal(f + 1024)); } });
+
+	// a dashboard: 20 windows, drawn by one Window_manager::check() per frame. n points in total
+	s.push_back({ "dashboard", 20,
+		[](std::vector<Multiplot*>& m, size_t n)
+		{
+			for (size_t i = 0; i < n; i++) { m[i % m.size()]->plot(float(i / m.size()), signal(i)); }
+			return n;
+		},
+		[](std::vector<Multiplot*>& m, size_t n, int f)
+		{
+			for (size_t k = 0; k < m.size(); k++) { m[k]->plot(float(n / m.size() + f), signal(f + 64 * k)); }
+		}, true });
+
+	return s;
+}
+
+static Result run(const Scenario& s, size_t n, const Settings& settings)
+{
+	Result r;
+	r.scenario = s.name;
+	r.points = n;
+	reset_peak_memory();
+	{
+		std::vector<std::unique_ptr<Multiplot>> windows;
+		std::vector<Multiplot*> m;
+		for (int k = 0; k < s.windows; k++)
+		{
+			windows.emplace_back(new Multiplot(20, 20 + k * (settings.height + 40), settings.width, settings.height));
+			windows.back()->frame_rate_limit(0);
+			m.push_back(windows.back().get());
+		}
+
+		Clock::time_point t0 = Clock::now();
+		r.ingested = s.ingest(m, n);
+		r.ingest_s = seconds_since(t0);
+
+		frame(m, s.window_manager); // the first frame uploads everything
+		t0 = Clock::now();
+		for (int f = 0; f < settings.frames && seconds_since(t0) < settings.seconds; f++)
+		{
+			const Clock::time_point t = Clock::now();
+			s.update(m, n, f);
+			frame(m, s.window_manager);
+			r.frame_ms.push_back(1000.0 * seconds_since(t));
+		}
+		if (int(r.frame_ms.size()) < settings.frames) { r.note = "time limit reached after " + std::to_string(r.frame_ms.size()) + " frames"; }
+	}
+	r.peak_rss_mb = peak_memory_mb();
+	return r;
+}
+
+static const char* backend()
+{
+	#if defined(MULTIPLOT_SOFTWARE)
+	return "software";
+	#elif defined(MULTIPLOT_HEADLESS)
+	return "headless";
+	#elif defined(MULTIPLOT_FLTK)
+	return "fltk";
+	#else
+	return "win32";
+	#endif
+}
+
+static void write_json(FILE* f, const std::vector<Result>& results, const Settings& settings)
+{
+	fprintf(f, "{\n\t\"backend\": \"%s\",\n\t\"width\": %d,\n\t\"height\": %d,\n\t\"frames\": %d,\n\t\"results\": [\n",
+		backend(), settings.width, settings.height, settings.frames);
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& r = results[i];
+		fprintf(f, "\t\t{ \"scenario\": \"%s\", \"points\": %zu, \"ingest_s\": %.6f, \"ingest_points_per_s\": %.0f, ",
+			r.scenario.c_str(), r.points, r.ingest_s, r.ingest_s > 0 ? r.ingested / r.ingest_s : 0.0);
+		fprintf(f, "\"frame_ms\": { \"count\": %zu, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f }, \"peak_rss_mb\": %.1f",
+			r.frame_ms.size(), percentile(r.frame_ms, 50), percentile(r.frame_ms, 90), percentile(r.frame_ms, 99), percentile(r.frame_ms, 100), r.peak_rss_mb);
+		if (!r.note.empty()) { fprintf(f, ", \"note\": \"%s\"", r.note.c_str()); }
+		fprintf(f, " }%s\n", i + 1 < results.size() ? "," : "");
+	}
+	fprintf(f, "\t]\n}\n");
+}
+
+int main(int argc, char** argv)
+{
+	Settings settings;
+	for (int a = 1; a + 1 < argc; a += 2)
+	{
+		const std::string arg = argv[a], value = argv[a + 1];
+		if (arg == "--max-points") { settings.max_points = size_t(atof(value.c_str())); }
+		else if (arg == "--frames") { settings.frames = atoi(value.c_str()); }
+		else if (arg == "--seconds") { settings.seconds = atof(value.c_str()); }
+		else if (arg == "--only") { settings.only = value; }
+		else if (arg == "--json") { settings.json = value; }
+		else { fprintf(stderr, "unknown option %s\n", arg.c_str()); return EXIT_FAILURE; }
+	}
+
+	std::vector<Result> results;
+	for (const Scenario& s : scenarios())
+	{
+		if (!settings.only.empty() && settings.only != s.name) { continue; }
+		for (size_t n = 1000; n <= settings.max_points; n *= 10)
+		{
+			fprintf(stderr, "%-12s %10zu points ... ", s.name, n);
+			results.push_back(run(s, n, settings));
+			const Result& r = results.back();
+			fprintf(stderr, "ingest %.3g points/s, frame p50 %.2f ms, peak %.0f MB\n", r.ingest_s > 0 ? r.ingested / r.ingest_s : 0.0, percentile(r.frame_ms, 50), r.peak_rss_mb);
+		}
+	}
+
+	FILE* f = settings.json.empty() ? stdout : fopen(settings.json.c_str(), "w");
+	if (!f) { fprintf(stderr, "cannot write %s\n", settings.json.c_str()); return EXIT_FAILURE; }
+	write_json(f, results, settings);
+	if (f != stdout) { fclose(f); }
+	return EXIT_SUCCESS;
+}
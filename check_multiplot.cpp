@@ -0,0 +1,309 @@
+// checks of multiplot that run without a display: each check plots something, reads the
+// result back (bounds, decoded points, rendered pixels) and compares it with the expected
+// one. prints the failed checks and exits with 1 if any failed. see make.sh for how to
+// compile it.
+//
+//	check_multiplot
+//
+// runs headless (egl) by default. compile with -DMULTIPLOT_SOFTWARE to check the
+// software rasterizer.
+
+#if !defined(MULTIPLOT_SOFTWARE) && !defined(MULTIPLOT_FLTK) && !defined(_WIN32)
+#define MULTIPLOT_HEADLESS
+#endif
+#include "multiplot.h"
+
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace multiplot;
+
+// the protected parts of a trace that the checks look at
+struct Trace_internals : Multiplot::Trace
+{
+	static const auto& history_of(const Multiplot::Trace& t) { return t.*(&Trace_internals::history); }
+	static const auto& styles_of(const Multiplot::Trace& t) { return t.*(&Trace_internals::styles); }
+	static bool& uniform_line_width_of(Multiplot::Trace& t) { return t.*(&Trace_internals::uniform_line_width); }
+	static auto origin_of(const Multiplot::Trace& t) { return t.*(&Trace_internals::origin); }
+};
+
+static int checks = 0, failed = 0;
+
+#define CHECK(condition) check(condition, #condition, __FILE__, __LINE__)
+
+static void check(bool ok, const char* condition, const char* file, int line)
+{
+	checks++;
+	if (ok) { return; }
+	failed++;
+	fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+}
+
+// the pixels of the window, as save() writes them
+static std::string pixels(Multiplot& m)
+{
+	const std::string file = "check_multiplot.ppm";
+	m.save(file);
+	std::ifstream in(file, std::ios::binary);
+	const std::string p((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	in.close();
+	std::remove(file.c_str());
+	return p;
+}
+
+// the number of pixels in which two images of save() with the same size differ
+static size_t differing_pixels(const std::string& a, const std::string& b, size_t width, size_t height)
+{
+	if (a.size() != b.size() || a.size() < width * height * 3) { return width * height; }
+	size_t n = 0;
+	for (size_t i = a.size() - width * height * 3; i < a.size(); i += 3) { n += a.compare(i, 3, b, i, 3) != 0; }
+	return n;
+}
+
+static void write_file(const std::string& file, const std::string& bytes)
+{
+	std::ofstream out(file, std::ios::binary);
+	out.write(bytes.data(), std::streamsize(bytes.size()));
+}
+
+static bool finite(double a, double b, double c, double d) { return std::isfinite(a) && std::isfinite(b) && std::isfinite(c) && std::isfinite(d); }
+
+// a nan at the start of a block must not hide the other points from the bounds
+static void check_bounds_nan()
+{
+	Multiplot m(0, 0, 320, 240);
+	m.plot(NAN, NAN);
+	for (int i = 1; i < 1000; i++) { m.plot(i, sin(0.01 * i)); }
+	double x_min, y_min, x_max, y_max;
+	CHECK(m[0].bounds(x_min, y_min, x_max, y_max));
+	CHECK(finite(x_min, y_min, x_max, y_max));
+	CHECK(x_min == 1.0 && x_max == 999.0);
+
+	std::vector<float> y(1000);
+	for (size_t i = 0; i < y.size(); i++) { y[i] = (i % 64 == 0) ? NAN : float(i); }
+	m.view(0).data(y.data(), y.size());
+	CHECK(m.view(0).bounds(x_min, y_min, x_max, y_max));
+	CHECK(finite(x_min, y_min, x_max, y_max));
+	CHECK(y_min == 1.0 && y_max == 999.0);
+}
+
+// the points that drop out of a scrolling trace must not stay in the bounds or the pyramid
+static void check_scrolling_eviction()
+{
+	const int n = 1000;
+	for (MP_SCROLLING scroll : { MP_SCROLL_LEFT, MP_SCROLL_WARP })
+	{
+		Multiplot m(0, 0, 320, 240), reference(0, 0, 320, 240);
+		m.scrolling(scroll, n);
+		for (int i = 0; i < 3 * n + 123; i++)
+		{
+			const double y = i < n ? 1000.0 : sin(0.01 * i); // the first points are far away
+			m.plot(i, y);
+			if (i >= 2 * n + 123) { reference.plot(i, y); }
+		}
+		double x_min, y_min, x_max, y_max;
+		CHECK(m[0].bounds(x_min, y_min, x_max, y_max));
+		CHECK(x_min == double(2 * n + 123) && x_max == double(3 * n + 122));
+		CHECK(y_max <= 1.0 && y_min >= -1.0);
+		if (scroll == MP_SCROLL_LEFT) { CHECK(pixels(m) == pixels(reference)); }
+	}
+}
+
+// the decimated trace covers the same pixels as the trace drawn point by point. opengl leaves
+// out the last pixel of a line, so where a column ends in a steep step a few pixels may differ
+static void check_decimation()
+{
+	#ifdef MULTIPLOT_SOFTWARE
+	const size_t tolerance = 0;
+	#else
+	const size_t tolerance = 16;
+	#endif
+	for (float width : { 1.0f, 3.0f })
+	{
+		Multiplot m(0, 0, 320, 240);
+		m.linewidth(width);
+		const int n = 200000;
+		for (int i = 0; i < n; i++) { m.plot(0.001 * i, sin(0.0001 * i) + 0.2 * sin(0.37 * i) + ((i / 5000) % 7 == 3 ? 1.5 : 0.0)); }
+		m.collect_metrics();
+		const std::string decimated = pixels(m);
+		CHECK(m.metrics().back().decimation() > 10.0);
+		Trace_internals::uniform_line_width_of(m[0]) = false; // draws the trace point by point
+		const std::string full = pixels(m);
+		CHECK(m.metrics().back().decimation() <= 1.0);
+		CHECK(differing_pixels(decimated, full, 320, 240) <= tolerance);
+	}
+}
+
+// compressed points decode to the float offsets an uncompressed trace stores, or within half
+// a quantum of the plotted values
+static void check_compression()
+{
+	for (double quantum : { 0.0, 0.01 })
+	{
+		Multiplot::Trace t;
+		t.compression(1024, quantum);
+		std::vector<double> xs, ys;
+		for (int i = 0; i < 20000; i++)
+		{
+			if (i == 5000) { t.color3f(1.0f, 0.0f, 0.0f); }
+			xs.push_back(1.7e9 + 0.001 * i);
+			ys.push_back(i % 1000 == 999 ? NAN : 20.0 + 5.0 * sin(1e-3 * i) + (i % 3) * 0.125);
+			t.plot(xs.back(), ys.back());
+		}
+		const auto& history = Trace_internals::history_of(t);
+		CHECK(!history.empty());
+		CHECK(history.size() + t.size() == xs.size());
+		std::vector<std::decay<decltype(history.blocks[0].key[0])>::type> decoded;
+		size_t i = 0;
+		bool exact = true, colors = true;
+		double error = 0.0;
+		for (size_t k = 0; k < history.blocks.size(); k++)
+		{
+			const auto base = history.blocks[k].base;
+			history.decode(k, decoded);
+			for (const auto& p : decoded)
+			{
+				if (p.x != float(xs[i] - base.x)) { exact = false; }
+				if (quantum == 0.0 && !(p.y == float(ys[i] - base.y) || (std::isnan(p.y) && std::isnan(ys[i])))) { exact = false; }
+				if (quantum > 0.0 && !std::isnan(ys[i])) { error = std::max(error, std::fabs(base.y + p.y - ys[i])); }
+				if ((i >= 5000) != (p.g == 0.0f)) { colors = false; }
+				i++;
+			}
+		}
+		CHECK(i == history.size());
+		CHECK(exact);
+		CHECK(colors);
+		CHECK(error <= 0.5 * quantum + 1e-5);
+
+		// the uncompressed rest follows the last block
+		const auto origin = Trace_internals::origin_of(t);
+		bool rest = true;
+		for (size_t j = 0; j < t.size(); j++) { if (t[j].x != float(xs[i + j] - origin.x)) { rest = false; } }
+		CHECK(rest);
+	}
+
+	// a compressed trace looks like an uncompressed one
+	Multiplot a(0, 0, 320, 240), b(0, 0, 320, 240);
+	a.compression(1024);
+	for (int i = 0; i < 20000; i++) { a.plot(i, sin(0.001 * i)); b.plot(i, sin(0.001 * i)); }
+	CHECK(pixels(a) == pixels(b));
+}
+
+// a recorded session replays into the same plot
+static void check_session()
+{
+	const std::string file = "check_multiplot.mps";
+	Multiplot a(0, 0, 320, 240), b(0, 0, 320, 240);
+	a.record(file);
+	for (int i = 0; i < 2000; i++) { a.plot(i, sin(0.01 * i)); }
+	a.redraw();
+	a.trace(1);
+	a.color3f(1.0f, 0.5f, 0.0f);
+	a.linewidth(2.0f);
+	a.pointsize(3.0f);
+	a.scrolling(500);
+	std::vector<float> y(3000);
+	for (size_t i = 0; i < y.size(); i++) { y[i] = float(cos(0.003 * i)); }
+	a.plot(y.data(), y.size());
+	a.trace(2);
+	a.plot(1.0, 1.0);
+	a.clear(2);
+	a.plot(5.0, -1.0);
+	a.redraw();
+	a.stop_recording();
+
+	b.frame_rate_limit(0);
+	CHECK(b.replay(file, 0.0));
+	std::remove(file.c_str());
+	for (int t = 0; t < 3; t++) { CHECK(a[t].size() == b[t].size()); }
+	CHECK(pixels(a) == pixels(b));
+
+	write_file(file, "MPSESS0\n");
+	bool rejected = false;
+	try { b.replay(file, 0.0); } catch (const std::runtime_error&) { rejected = true; }
+	std::remove(file.c_str());
+	CHECK(rejected);
+}
+
+// a damaged .npy header is an error, not a crash or an exception of another type
+static void check_npy()
+{
+	const std::string file = "check_multiplot.npy";
+	auto npy = [](std::string header, size_t data)
+	{
+		// like numpy, the header is padded so the data starts at a multiple of 64 bytes
+		while (data > 0 && (10 + header.size() + 1) % 64) { header += ' '; }
+		if (data > 0) { header += '\n'; }
+		std::string f("\x93NUMPY\x01\x00", 8);
+		f += char(header.size() & 0xff);
+		f += char(header.size() >> 8);
+		return f + header + std::string(data, '\0');
+	};
+	auto opens = [&file](const std::string& bytes)
+	{
+		write_file(file, bytes);
+		Multiplot m(0, 0, 64, 64);
+		int result = 0;
+		try { m.view(0).open_file(file); result = 1; }
+		catch (const std::runtime_error&) { result = 0; }
+		catch (...) { result = -1; }
+		std::remove(file.c_str());
+		return result;
+	};
+	CHECK(opens(npy("{'descr': '<f4', 'fortran_order': False, 'shape': (4,), }", 16)) == 1);
+	CHECK(opens(npy("{'fortran_order': False, 'shape': (4,), }", 16)) == 0);		// no type
+	CHECK(opens(npy("{'descr': '<f", 0)) == 0);										// type cut off
+	CHECK(opens(npy("{'descr': '>f4', 'fortran_order': False, 'shape': (4,), }", 16)) == 0);	// big endian
+	CHECK(opens(npy("{'descr': '<c8', 'fortran_order': False, 'shape': (4,), }", 32)) == 0);	// complex
+	CHECK(opens(npy("{'descr': '<f4', 'fortran_order': False, 'shape': (4, 2, 2), }", 64)) == 0);
+	CHECK(opens(npy("{'descr': '<f4', 'fortran_order': False, 'shape': (400,), }", 16)) == 0);	// truncated data
+	CHECK(opens(std::string("\x93NUMPY\x02\x00\x05\x00", 10)) == 0);					// version 2, header cut off
+	CHECK(opens(std::string("\x93NUMPY\x01\x00\xff\x00{}", 12)) == 0);					// header longer than the file
+}
+
+// the style runs follow the points when the trace is shrunk and grown through the vector interface
+static void check_style_runs()
+{
+	Multiplot::Trace t;
+	for (int i = 0; i < 100; i++) { t.plot(i, 0.0); }
+	t.color3f(0.0f, 0.0f, 1.0f);
+	for (int i = 100; i < 200; i++) { t.plot(i, 1.0); }
+	const auto& runs = Trace_internals::styles_of(t).runs;
+	CHECK(runs.size() == 2 && runs[1].first == 100);
+
+	t.resize(150);
+	t.modified();
+	t.color3f(0.0f, 1.0f, 0.0f);
+	t.plot(150, 2.0);
+	CHECK(runs.size() == 3 && runs[1].first == 100 && runs[2].first == 150 && runs[2].style.g == 1.0f);
+
+	t.resize(50);	// drops the runs that start at 100 and 150
+	t.modified();
+	CHECK(runs.size() == 1 && runs[0].first == 0 && runs[0].style.b == 1.0f && runs[0].style.g == 1.0f);
+	t.resize(120);	// the new points get the style of the last run
+	t.modified();
+	CHECK(runs.size() == 1);
+	t.plot(120, 0.0);
+	CHECK(runs.size() == 2 && runs[1].first == 120);
+	CHECK(Trace_internals::styles_of(t)[119].b == 1.0f && Trace_internals::styles_of(t)[120].b == 0.0f);
+}
+
+int main()
+{
+	check_bounds_nan();
+	check_scrolling_eviction();
+	check_decimation();
+	check_compression();
+	check_session();
+	check_npy();
+	check_style_runs();
+	printf("%d of %d checks failed\n", failed, checks);
+	return failed ? 1 : 0;
+}
@@ -1 +1,9 @@
-g++ -std=c++14 test_multiplot.cpp -lfltk -lfltk_gl -lGL
\ No newline at end of file
+g++ -std=c++14 test_multiplot.cpp -lfltk -lfltk_gl -lGL
+# without a display (offscreen rendering with egl, see Multiplot::save()):
+# g++ -std=c++14 -DMULTIPLOT_HEADLESS test_multiplot.cpp -lEGL -lGL
+# without opengl (software rendering, see class Raster):
+# g++ -std=c++14 -O2 -DMULTIPLOT_SOFTWARE test_multiplot.cpp -lpthread
+# benchmark (json results on stdout, see benchmark_multiplot.cpp):
+# g++ -std=c++14 -O2 benchmark_multiplot.cpp -o benchmark_multiplot -lEGL -lGL -lpthread
+# checks without a display (exit code 1 if one fails, see check_multiplot.cpp):
+# g++ -std=c++14 -O2 check_multiplot.cpp -o check_multiplot -lEGL -lGL -lpthread && ./check_multiplot
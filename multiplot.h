@@ -62,6 +62,63 @@ INSTALL
 				  
 
 CHANGELOG
+	20261017 - v 0.6.0:
+	- traces are stored in opengl vertex buffer objects and drawn with a few glDrawArrays calls.
+	  scale and offset are applied through the modelview matrix, the point data stays untouched.
+	- only newly plotted points are uploaded to the graphics card (appended points or the
+	  overwritten slots of a scrolling trace).
+	- traces with non-decreasing x and many points per pixel are reduced to the first, minimum,
+	  maximum and last point of each pixel column before drawing (looks the same, but much faster).
+	- each trace keeps a min/max pyramid of its points. the decimation reads the level that
+	  matches the number of points per pixel, so its cost depends on the window width only.
+	- the bounds of a trace are kept up to date by the pyramid (including points that scroll out
+	  of a ringbuffer) instead of being searched every frame. query them with bounds(...).
+	- push(trace, x, y) can be called from any thread. the samples go through a lock-free queue
+	  with a selectable policy for a full queue (ingest_queue()) and are plotted at the next frame.
+	- render_thread(max_fps) moves the drawing and event handling into a thread with a frame rate
+	  cap. redraw() then only requests a frame and returns immediately.
+	- redraw() skips frames if nothing has changed and combines calls that come faster than
+	  frame_rate_limit() (60 fps by default). skipped_frames() counts the frames saved.
+	- the autoscaling bounds are computed before drawing, so the first frame is already scaled correctly.
+	- bulk plotting: plot(y, count, stride), plot(x, y, count, stride_x, stride_y), plot_range(first, last)
+	  and plot(std::array). plot(std::vector) uses the same path and no longer plots point by point.
+	- trace views: m.view(n).data(samples, count, stride) draws samples from your own memory
+	  (any integer or floating point type, optional x array) without copying them.
+	- m.view(n).open_file(filename, channel) draws a raw binary or .npy file through a memory mapping.
+	- record(filename) logs the plot calls to a compact binary file, replay(filename, speed) plays it back.
+	- headless backend: define MULTIPLOT_HEADLESS to render offscreen with egl, without a display.
+	  save(filename) writes the plot to a .png or .ppm file (with every backend).
+	- software backend: define MULTIPLOT_SOFTWARE to draw with the cpu, without opengl. lines and points
+	  are rasterized into a frame buffer in memory (raster()) by several threads.
+	- frame metrics: collect_metrics() keeps the time of each phase of the last frames (per trace, grid,
+	  caption, swap, event handling), vertex and draw call counts. query them with metrics(), show them
+	  with hud(true) or write them as chrome trace-event json with export_trace(filename).
+	- text: the y labels of the grid are drawn with a built-in 5x7 pixel font from a texture atlas, in one
+	  draw call and with every backend. labels and caption are formatted only when range or grid change.
+	- logarithmic axes: grid(MP_LINEAR_GRID, MP_LOG_GRID) makes the y axis logarithmic. the plotted points
+	  are kept, their vertices are transformed. grid lines and labels (now also on the x axis) are computed
+	  once per range change, and any range gets a limited number of lines.
+	- large values (e.g. unix timestamps): each trace stores its points as float offsets to a double base
+	  (base()), which moves along automatically. plot, push, scaling and bounds take doubles.
+	- compressed history: compression(block_points, quantum) seals the older points of a trace in compressed
+	  blocks (lossless xor / delta coding, or y rounded to a quantum), about 3-5 instead of 8 bytes per point.
+	  blocks are decoded only when a frame needs their points.
+	- density maps: density() draws a scatter trace as a histogram with one bin per pixel, colored by the
+	  (logarithmic) count and drawn as one texture. new points are counted incrementally.
+	- api change: a point of a trace (Point2d) holds x and y only, 8 instead of 28 bytes. color, line width
+	  and point size are stored once per run of points with the same style and drawn with one state change
+	  per run; traces with many runs (e.g. a color per point) are drawn with a color array as before.
+	- culling: a trace only draws the points in the window (and their neighbours), found by binary search
+	  if x is sorted or through the min/max pyramid otherwise. zooming into a long trace costs only the
+	  points that are shown.
+	- mouse navigation: the mouse wheel zooms, dragging moves the view, dragging with the right button
+	  zooms into a box and a double click zooms out again (FLTK and win32, see navigation()). while the
+	  mouse moves, a slow frame is replaced by the last one, stretched to the new view, so this stays
+	  smooth with any number of points. zoom(), pan(), zoom_box() and unzoom() do the same from code.
+	- Window_manager::instance().check() handles the events of all windows at once and draws the windows
+	  that have changed, the ones that waited longest first, within an optional frame_budget(). the gl
+	  contexts of all windows share their objects (one font texture for all). win32 now supports more
+	  than one window: closing one (or ESC) only closes that window.
 	20190225 - v 0.5.6:
 	- api change: "set_" prefix removed from all member functions
 	- several bugfixes, compiles also on  raspberry pi
@@ -116,13 +173,30 @@ CHANGELOG
 	- initial release
 */
 
-// currently, fltk is the only backend for linux. so we can safely activate it if we are not running under _win32
-#ifdef _WIN32
+// currently, fltk is the only backend for linux. so we can safely activate it if we are not running under _win32.
+// define MULTIPLOT_HEADLESS to render offscreen (egl) without a window, e.g. on a server without a display.
+// define MULTIPLOT_SOFTWARE to draw on the cpu into a frame buffer in memory, without opengl (see class Raster).
+#ifdef MULTIPLOT_SOFTWARE
+	#undef MULTIPLOT_FLTK
+	#undef MULTIPLOT_WIN32
+	#undef MULTIPLOT_HEADLESS
+#elif defined(MULTIPLOT_HEADLESS)
+	#undef MULTIPLOT_FLTK
+	#undef MULTIPLOT_WIN32
+	#ifndef GL_GLEXT_PROTOTYPES
+	#define GL_GLEXT_PROTOTYPES 1
+	#endif
+#elif defined(_WIN32)
 	#ifndef MULTIPLOT_FLTK
 	#define MULTIPLOT_WIN32
 	#endif
 #else
 	#define MULTIPLOT_FLTK
+	// request the prototypes of the opengl 1.5 buffer object functions (glGenBuffers etc.)
+	// under windows, opengl32.dll only exports opengl 1.1, so they are loaded at runtime there.
+	#ifndef GL_GLEXT_PROTOTYPES
+	#define GL_GLEXT_PROTOTYPES 1
+	#endif
 #endif
 
 
@@ -137,11 +211,42 @@ CHANGELOG
 #include <thread>
 #include <chrono>
 #include <limits>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <type_traits>
+#include <array>
+#include <iterator>
+#include <stdexcept>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <deque>
 #include <locale>	// to convert wstring to string
 #include <codecvt>	// to convert wstring to string
 
 
-#ifdef MULTIPLOT_FLTK // tell multiplot to use Fltk to create an Opengl-Window
+#ifdef _WIN32	// for Mapped_file
+	#ifndef WIN32_LEAN_AND_MEAN
+	#define WIN32_LEAN_AND_MEAN 1
+	#endif
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#ifdef MULTIPLOT_SOFTWARE
+	// no opengl headers: the functions multiplot needs are implemented on top of class Raster
+#elif defined(MULTIPLOT_HEADLESS)
+	#include <EGL/egl.h>
+	#include <EGL/eglext.h>
+	#include <GL/gl.h>
+#elif defined(MULTIPLOT_FLTK) // tell multiplot to use Fltk to create an Opengl-Window
 	#include <sstream>
 	#include <FL/gl.h>
 	#include <FL/Fl.H>
@@ -192,973 +297,6106 @@ enum MP_SCROLLING
 	MP_NO_SCROLL,
 	MP_SCROLL_LEFT,  // plot scrolls from right to left
 	MP_SCROLL_RIGHT, // TODO plot scrolls from left to right 
-	MP_SCROLL_WARP   //  similiar to an Oscilloscope 
+	MP_SCROLL_WARP   //  similiar to an Oscilloscope
 };
 
 
-//////////////////////////////////////////////////////////////////////////
-// now comes platform specific code for opening a window to draw in
-
-#ifdef MULTIPLOT_FLTK
-
-class Multiplot_base : public Fl_Gl_Window
+/**
+*	element type of the samples a Trace_view refers to
+*/
+enum MP_DTYPE
 {
-protected:
-	unsigned int width = 0;
-	unsigned int height = 0;
-	std::string caption_str;
-public:
-	/**
-	*	this constructor tells multiplot where to put the window on the 
-	*	desktop in pixel-coordinates(x,y) and with wich width and height (w,h)
-	*/
-	Multiplot_base(int x, int y, int w, int h, const std::wstring& title_, bool fullscreen_) : Fl_Gl_Window(x,y,w,h) 
-	  {
-		  width = w;
-		  height = h;
-		  resizable(*this);
-		  caption(title_);
-		  if (fullscreen_) { fullscreen(); }
-	  }
-
-	  bool check()
-	  { 
-		  if (Fl::check()) { return true; } else return false; 
-	  }
-
-	  virtual void draw() override
-	  {
-		  //Fl_Gl_Window::draw();
-	  }
-
-	  void caption(const std::string& t)
-	  {
-		  caption_str = t;
-		  this->label(caption_str.c_str());
-	  }
-	  void caption(const std::wstring& t)
-	  {
-		  //setup converter
-		  using convert_type = std::codecvt_utf8<wchar_t>;
-		  caption_str = std::wstring_convert<convert_type, wchar_t>().to_bytes(t);
-		  this->label(caption_str.c_str());
-	  }
+	MP_INT8,
+	MP_UINT8,
+	MP_INT16,
+	MP_UINT16,
+	MP_INT32,
+	MP_UINT32,
+	MP_INT64,
+	MP_UINT64,
+	MP_FLOAT,
+	MP_DOUBLE
+};
 
-	  void redraw()
-	  {
-		  check();
-		  Fl_Gl_Window::redraw();
-	  }
+// the MP_DTYPE of a c++ type, e.g. dtype_of<short>() == MP_INT16
+template<class T> MP_DTYPE dtype_of()
+{
+	static_assert(std::is_arithmetic<T>::value && sizeof(T) <= 8, "Multiplot: unsupported sample type");
+	static_assert(!std::is_floating_point<T>::value || sizeof(T) == 4 || sizeof(T) == 8, "Multiplot: unsupported sample type");
+	const bool s = std::is_signed<T>::value;
+	return std::is_floating_point<T>::value ? (sizeof(T) == 4 ? MP_FLOAT : MP_DOUBLE)
+		: sizeof(T) == 1 ? (s ? MP_INT8 : MP_UINT8)
+		: sizeof(T) == 2 ? (s ? MP_INT16 : MP_UINT16)
+		: sizeof(T) == 4 ? (s ? MP_INT32 : MP_UINT32)
+		: (s ? MP_INT64 : MP_UINT64);
+}
 
-}; 
-#endif
+/**
+* What happens if a producer thread pushes a sample into a full ingestion queue
+* (see Multiplot::push())
+*/
+enum MP_BACKPRESSURE
+{
+	MP_DROP_OLDEST,	// discard the oldest queued sample to make room
+	MP_DROP_NEWEST,	// discard the sample that is pushed
+	MP_BLOCK		// wait until the drawing thread has made room
+};
 
-#ifdef MULTIPLOT_WIN32
 
 /**
-* class Multiplot_base is for low level Window handling
-* and creates an OpenGL Context.
+* a bounded lock-free queue for samples that are pushed by several producer threads
+* and taken out by the drawing thread (D. Vyukov's bounded queue: every cell carries a
+* sequence number that tells producers and the consumer whose turn it is).
+* producers may also take samples out, which is used to drop the oldest samples.
 */
-class Multiplot_base
+template<class T> class Sample_queue
 {
-protected:
+public:
+	std::atomic<unsigned long long> pushed{ 0 };			// number of samples that made it into the queue
+	std::atomic<unsigned long long> dropped_oldest{ 0 };	// number of queued samples discarded by MP_DROP_OLDEST
+	std::atomic<unsigned long long> dropped_newest{ 0 };	// number of samples rejected by MP_DROP_NEWEST
+	const MP_BACKPRESSURE policy;
 
-	unsigned int width; // window - width
-	unsigned int height; // window - height
-	std::wstring title_str;
-	bool valid_;
+	// the capacity is rounded up to the next power of two
+	Sample_queue(size_t capacity_, MP_BACKPRESSURE policy_) : policy(policy_)
+	{
+		size_t c = 2;
+		while (c < capacity_) { c *= 2; }
+		mask = c - 1;
+		cells.reset(new Cell[c]);
+		for (size_t i = 0; i < c; i++) { cells[i].seq.store(i, std::memory_order_relaxed); }
+	}
 
-	bool active;
-	bool fullscreen;
-	HDC			hDC;		// Private GDI Device Context
-	HGLRC		hRC;		// Permanent Rendering Context
-	HWND		hWnd;		// Holds Our Window Handle
-	HINSTANCE	hInstance;	// Holds The Instance Of The Application
-	
+	size_t capacity() const { return mask + 1; }
 
-	static LRESULT CALLBACK StaticWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
+	// approximate number of queued samples
+	size_t size() const
 	{
-		Multiplot_base* pParent;
+		size_t e = enqueue_pos.load(std::memory_order_relaxed);
+		size_t d = dequeue_pos.load(std::memory_order_relaxed);
+		return e > d ? e - d : 0;
+	}
 
-		// Get pointer to window
-		if(uMsg == WM_CREATE)
-		{
-			pParent = (Multiplot_base*)((LPCREATESTRUCT)lParam)->lpCreateParams;
-			SetWindowLongPtr(hWnd, GWLP_USERDATA,(LONG_PTR)pParent);
-		}
-		else
+	/**
+	*	inserts a sample, handling a full queue according to the backpressure policy.
+	*	safe to call from any number of threads.
+	*/
+	void push(const T& v)
+	{
+		while (!try_push(v))
 		{
-			pParent = (Multiplot_base*)GetWindowLongPtr(hWnd, GWLP_USERDATA);
-			if(!pParent) return DefWindowProc(hWnd,uMsg,wParam,lParam);
+			if (MP_DROP_NEWEST == policy)
+			{
+				dropped_newest.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			if (MP_DROP_OLDEST == policy)
+			{
+				T old;
+				if (try_pop(old)) { dropped_oldest.fetch_add(1, std::memory_order_relaxed); }
+			}
+			else
+			{
+				std::this_thread::yield(); // MP_BLOCK
+			}
 		}
-
-		pParent->hWnd = hWnd;
-		return pParent->WndProc(uMsg,wParam,lParam);
+		pushed.fetch_add(1, std::memory_order_relaxed);
 	}
 
-	LRESULT WndProc(				// Handle For This Window
-		UINT	uMsg,			// Message For This Window
-		WPARAM	wParam,			// Additional Message Information
-		LPARAM	lParam)			// Additional Message Information
+	bool try_push(const T& v)
 	{
-
-		switch (uMsg)									// Check For Windows Messages
+		Cell* c;
+		size_t p = enqueue_pos.load(std::memory_order_relaxed);
+		for (;;)
 		{
-		case WM_ACTIVATE:							// Watch For Window Activate Message
+			c = &cells[p & mask];
+			const size_t seq = c->seq.load(std::memory_order_acquire);
+			const ptrdiff_t dif = ptrdiff_t(seq) - ptrdiff_t(p);
+			if (dif == 0)
 			{
-				if (!HIWORD(wParam))					// Check Minimization State
-				{
-					active=TRUE;						// Program Is Active
-				}
-				else
-				{
-					active=FALSE;						// Program Is No Longer Active
-				}
-
-				return 0;								// Return To The Message Loop
+				if (enqueue_pos.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) { break; }
 			}
-
-		case WM_SYSCOMMAND:							// Intercept System Commands
+			else if (dif < 0)
 			{
-				switch (wParam)							// Check System Calls
-				{
-				case SC_SCREENSAVE:					// Screensaver Trying To Start?
-				case SC_MONITORPOWER:				// Monitor Trying To Enter Powersave?
-					return 0;							// Prevent From Happening
-				}
-				break;									// Exit
+				return false; // full
 			}
-
-		case WM_CLOSE:								// Did We Receive A Close Message?
+			else
 			{
-				PostQuitMessage(0);						// Send A Quit Message
-				return 0;								// Jump Back
+				p = enqueue_pos.load(std::memory_order_relaxed);
 			}
+		}
+		c->data = v;
+		c->seq.store(p + 1, std::memory_order_release);
+		return true;
+	}
 
-		case WM_KEYDOWN:							// Is A Key Being Held Down?
+	bool try_pop(T& v)
+	{
+		Cell* c;
+		size_t p = dequeue_pos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			c = &cells[p & mask];
+			const size_t seq = c->seq.load(std::memory_order_acquire);
+			const ptrdiff_t dif = ptrdiff_t(seq) - ptrdiff_t(p + 1);
+			if (dif == 0)
 			{
-				//keys[wParam] = TRUE;					// If So, Mark It As TRUE
-				return 0;								// Jump Back
+				if (dequeue_pos.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) { break; }
 			}
-
-		case WM_KEYUP:								// Has A Key Been Released?
+			else if (dif < 0)
 			{
-				//keys[wParam] = FALSE;				// If So, Mark It As FALSE
-				return 0;							// Jump Back
+				return false; // empty
 			}
-
-		case WM_SIZE:								// Resize The OpenGL Window
+			else
 			{
-				width = LOWORD(lParam);
-				height = HIWORD(lParam);
-				valid_ = false;						// set flag to tell we need to re-init opengl
-				return 0;							// Jump Back
+				p = dequeue_pos.load(std::memory_order_relaxed);
 			}
 		}
+		v = c->data;
+		c->seq.store(p + mask + 1, std::memory_order_release);
+		return true;
+	}
 
-		// Pass All Unhandled Messages To DefWindowProc
-		return DefWindowProc(hWnd,uMsg,wParam,lParam);
+protected:
+	struct Cell
+	{
+		std::atomic<size_t> seq;
+		T data;
+	};
+	std::unique_ptr<Cell[]> cells;
+	size_t mask = 0;
+	// keep the producer and consumer positions on separate cache lines
+	char pad0[64];
+	std::atomic<size_t> enqueue_pos{ 0 };
+	char pad1[64];
+	std::atomic<size_t> dequeue_pos{ 0 };
+	char pad2[64];
+};
+
+
+/**
+*	a read-only memory mapping of a whole file. the operating system reads the pages
+*	from disk when they are accessed, so mapping even a huge file takes no time.
+*	throws std::runtime_error if the file cannot be opened.
+*/
+class Mapped_file
+{
+public:
+	explicit Mapped_file(const std::string& filename)
+	{
+		#ifdef _WIN32
+		file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		LARGE_INTEGER size;
+		if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) { close(); throw std::runtime_error("Multiplot: cannot open " + filename); }
+		n = size_t(size.QuadPart);
+		if (n == 0) { return; }
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping) { p = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)); }
+		#else
+		fd = open(filename.c_str(), O_RDONLY);
+		struct stat st;
+		if (fd < 0 || fstat(fd, &st) != 0) { close(); throw std::runtime_error("Multiplot: cannot open " + filename); }
+		n = size_t(st.st_size);
+		if (n == 0) { return; }
+		void* m = mmap(NULL, n, PROT_READ, MAP_SHARED, fd, 0);
+		if (m != MAP_FAILED) { p = static_cast<const char*>(m); }
+		#endif
+		if (!p) { close(); throw std::runtime_error("Multiplot: cannot map " + filename); }
 	}
 
+	~Mapped_file() { close(); }
 
+	Mapped_file(const Mapped_file&) = delete;
+	Mapped_file& operator=(const Mapped_file&) = delete;
 
+	const char* data() const { return p; }
+	size_t size() const { return n; }
 
+protected:
+	const char* p = nullptr;
+	size_t n = 0;
+	#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+	#else
+	int fd = -1;
+	#endif
 
-	/*	This Code Creates Our OpenGL Window.  Parameters Are:					*
-	*	width			- Width Of The GL Window Or Fullscreen Mode				*
-	*	height			- Height Of The GL Window Or Fullscreen Mode			*
-	*	bits			- Number Of Bits To Use For Color (8/16/24/32)			*
-	*/ 
-	bool CreateGLWindow(int x, int y, int width, int height, const std::wstring& title, BYTE bits=0, bool fullscreenflag=false)
+	void close()
 	{
-		GLuint		PixelFormat;			// Holds The Results After Searching For A Match
-		WNDCLASS	wc;						// Windows Class Structure
-		DWORD		dwExStyle;				// Window Extended Style
-		DWORD		dwStyle;				// Window Style
-		RECT		WindowRect;				// Grabs Rectangle Upper Left / Lower Right Values
-		WindowRect.left=(long)0;			// Set Left Value To 0
-		WindowRect.right=(long)width;		// Set Right Value To Requested Width
-		WindowRect.top=(long)0;				// Set Top Value To 0
-		WindowRect.bottom=(long)height;		// Set Bottom Value To Requested Height
+		#ifdef _WIN32
+		if (p) { UnmapViewOfFile(p); }
+		if (mapping) { CloseHandle(mapping); }
+		if (file != INVALID_HANDLE_VALUE) { CloseHandle(file); }
+		mapping = NULL; file = INVALID_HANDLE_VALUE;
+		#else
+		if (p) { munmap(const_cast<char*>(p), n); }
+		if (fd >= 0) { ::close(fd); }
+		fd = -1;
+		#endif
+		p = nullptr;
+	}
+};
 
-		fullscreen=fullscreenflag;			// Set The Global Fullscreen Flag
-		title_str = title;
 
-		hInstance			= GetModuleHandle(NULL);				// Grab An Instance For Our Window
-		wc.style			= CS_HREDRAW | CS_VREDRAW | CS_OWNDC;	// Redraw On Size, And Own DC For Window.
-		wc.lpfnWndProc		= (WNDPROC) (Multiplot_base::StaticWndProc);// window_handler Handles Messages
-		wc.cbClsExtra		= 0;									// No Extra Window Data
-		wc.cbWndExtra		= 0;									// No Extra Window Data
-		wc.hInstance		= hInstance;							// Set The Instance
-		wc.hIcon			= LoadIcon(NULL, IDI_WINLOGO);			// Load The Default Icon
-		wc.hCursor			= LoadCursor(NULL, IDC_ARROW);			// Load The Arrow Pointer
-		wc.hbrBackground	= NULL;									// No Background Required For GL
-		wc.lpszMenuName		= NULL;									// We Don't Want A Menu
-		wc.lpszClassName	= L"OpenGL";								// Set The Class Name
+/**
+*	writes the calls that change a plot to a compact binary file, see Multiplot::record().
+*	the file starts with the 8 bytes "MPSESS1\n", followed by records: an opcode byte,
+*	the time since the previous record in microseconds as varint (7 bits per byte, low
+*	bits first) and the arguments. floats are stored as 4 little endian bytes (doubles as 8). calls
+*	for a different trace than the previous one are preceded by an OP_TRACE record.
+*/
+class Session_recorder
+{
+public:
+	enum Opcode : unsigned char
+	{
+		OP_TRACE = 1,	// varint trace
+		OP_PLOT,		// float x, float y
+		OP_PLOT_Y,		// varint count, count floats y. x is the index
+		OP_PLOT_XY,		// varint count, count pairs of floats x, y
+		OP_COLOR,		// float r, g, b
+		OP_LINEWIDTH,	// float width
+		OP_POINTSIZE,	// float size
+		OP_SCROLLING,	// varint MP_SCROLLING, varint max_points_to_plot
+		OP_CLEAR,		// no arguments
+		OP_REDRAW,		// no arguments
+		OP_PLOT_DOUBLE,	// double x, double y. a point that does not fit into floats
+		OP_DENSITY		// varint: 1 density map on, 2 logarithmic
+	};
 
+	explicit Session_recorder(const std::string& filename) : out(filename, std::ios::binary | std::ios::trunc)
+	{
+		if (!out) { throw std::runtime_error("Multiplot: cannot write " + filename); }
+		out.write("MPSESS1\n", 8);
+	}
 
-		if (!RegisterClass(&wc))									// Attempt To Register The Window Class
+	~Session_recorder() { flush(); }
+
+	// starts a record for the given trace
+	void op(unsigned int trace, Opcode code)
+	{
+		if (trace != cur_trace)
 		{
-			throw std::exception("Failed To Register The Window Class.");
+			cur_trace = trace;
+			op(OP_TRACE);
+			varint(trace);
 		}
+		op(code);
+	}
 
-		if (fullscreen)												// Attempt Fullscreen Mode?
-		{
-			DEVMODE dmScreenSettings;								// Device Mode
-			memset(&dmScreenSettings,0,sizeof(dmScreenSettings));	// Makes Sure Memory's Cleared
-			dmScreenSettings.dmSize=sizeof(dmScreenSettings);		// Size Of The Devmode Structure
-			dmScreenSettings.dmPelsWidth	= width;				// Selected Screen Width
-			dmScreenSettings.dmPelsHeight	= height;				// Selected Screen Height
-			dmScreenSettings.dmBitsPerPel	= bits;					// Selected Bits Per Pixel
-			dmScreenSettings.dmFields=DM_BITSPERPEL|DM_PELSWIDTH|DM_PELSHEIGHT;
+	// starts a record that does not belong to a trace
+	void op(Opcode code)
+	{
+		const uint64_t t = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+		buf.push_back(char(code));
+		varint(t - time);
+		time = t;
+		if (buf.size() > 65536) { flush(); }
+	}
 
-			// Try To Set Selected Mode And Get Results.  NOTE: CDS_FULLSCREEN Gets Rid Of Start Bar.
-			if (ChangeDisplaySettings(&dmScreenSettings,CDS_FULLSCREEN)!=DISP_CHANGE_SUCCESSFUL)
-			{
-				// If The Mode Fails, Offer Two Options.  Quit Or Use Windowed Mode.
-				std::cerr << "The Requested Fullscreen Mode is not supported by your Video Card. Using Windowed Mode instead." << std::endl;
-				fullscreen=false;		// Windowed Mode Selected.  Fullscreen = FALSE
-			}
-		}
+	void varint(uint64_t v)
+	{
+		while (v >= 0x80) { buf.push_back(char(v | 0x80)); v >>= 7; }
+		buf.push_back(char(v));
+	}
 
-		if (fullscreen)												// Are We Still In Fullscreen Mode?
-		{
-			dwExStyle=WS_EX_APPWINDOW;								// Window Extended Style
-			dwStyle=WS_POPUP;										// Windows Style
-			ShowCursor(FALSE);										// Hide Mouse Pointer
-		}
-		else
+	void f(float v)
+	{
+		uint32_t u;
+		memcpy(&u, &v, 4);
+		for (int k = 0; k < 4; k++) { buf.push_back(char(u >> (8 * k))); }
+	}
+
+	void d(double v)
+	{
+		uint64_t u;
+		memcpy(&u, &v, 8);
+		for (int k = 0; k < 8; k++) { buf.push_back(char(u >> (8 * k))); }
+	}
+
+	// records count points of a bulk plot. without x values, x is the index
+	template<class XS, class YS> void plot(unsigned int trace, const XS* xs, const YS& ys, size_t count)
+	{
+		op(trace, xs ? OP_PLOT_XY : OP_PLOT_Y);
+		varint(count);
+		for (size_t i = 0; i < count; i++)
 		{
-			dwExStyle=WS_EX_APPWINDOW | WS_EX_WINDOWEDGE;			// Window Extended Style
-			dwStyle=WS_OVERLAPPEDWINDOW;							// Windows Style
+			if (xs) { f(float((*xs)[i])); }
+			f(float(ys[i]));
+			if (buf.size() > 65536) { flush(); }
 		}
+	}
 
-		AdjustWindowRectEx(&WindowRect, dwStyle, FALSE, dwExStyle);		// Adjust Window To True Requested Size
+	void flush()
+	{
+		out.write(buf.data(), std::streamsize(buf.size()));
+		out.flush();
+		buf.clear();
+	}
 
-		// Create The Window
-		if (!(hWnd=CreateWindowEx(	dwExStyle,	// Extended Style For The Window
-			L"OpenGL",							// Class Name
-			title_str.c_str(),							// Window Title
-			dwStyle |							// Defined Window Style
-			WS_CLIPSIBLINGS |					// Required Window Style
-			WS_CLIPCHILDREN,					// Required Window Style
-			x, y,								// Window Position
-			WindowRect.right-WindowRect.left,	// Calculate Window Width
-			WindowRect.bottom-WindowRect.top,	// Calculate Window Height
-			NULL,								// No Parent Window
-			NULL,								// No Menu
-			hInstance,							// Instance
-			this)))								// Dont Pass Anything To WM_CREATE
-		{
-			//KillGLWindow();								// Reset The Display
-			throw std::exception("Window Creation Error.");
-		}
+protected:
+	std::ofstream out;
+	std::vector<char> buf;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint64_t time = 0;
+	unsigned int cur_trace = 0;
+};
 
-		static	PIXELFORMATDESCRIPTOR pfd=				// pfd Tells Windows How We Want Things To Be
-		{
-			sizeof(PIXELFORMATDESCRIPTOR),				// Size Of This Pixel Format Descriptor
-			1,											// Version Number
-			PFD_DRAW_TO_WINDOW |						// Format Must Support Window
-			PFD_SUPPORT_OPENGL |						// Format Must Support OpenGL
-			PFD_DOUBLEBUFFER,							// Must Support Double Buffering
-			PFD_TYPE_RGBA,								// Request An RGBA Format
-			bits,										// Select Our Color Depth
-			0, 0, 0, 0, 0, 0,							// Color Bits Ignored
-			0,											// No Alpha Buffer
-			0,											// Shift Bit Ignored
-			0,											// No Accumulation Buffer
-			0, 0, 0, 0,									// Accumulation Bits Ignored
-			16,											// 16Bit Z-Buffer (Depth Buffer)  
-			0,											// No Stencil Buffer
-			0,											// No Auxiliary Buffer
-			PFD_MAIN_PLANE,								// Main Drawing Layer
-			0,											// Reserved
-			0, 0, 0										// Layer Masks Ignored
-		};
 
-		if (!(hDC=GetDC(hWnd)))							// Did We Get A Device Context?
-		{
-			//KillGLWindow();								// Reset The Display
-			throw std::exception("Can't Create A GL Device Context.");
-		}
+//////////////////////////////////////////////////////////////////////////
+// writing images. the png encoder is minimal: rows are filtered with the "up" filter,
+// so unchanged pixels become runs of zeros, and deflated with the fixed huffman codes,
+// encoding runs of equal bytes as matches. plots compress well with that.
 
-		if (!(PixelFormat=ChoosePixelFormat(hDC,&pfd)))	// Did Windows Find A Matching Pixel Format?
-		{
-			//KillGLWindow();								// Reset The Display
-			throw(std::exception("Can't Find A Suitable PixelFormat."));
-		}
+class Image_writer
+{
+public:
+	/**
+	*	writes an rgb image (3 bytes per pixel, rows from top to bottom, or from bottom
+	*	to top if bottom_up) to a file. the format follows the extension: .png, otherwise
+	*	binary .ppm. throws std::runtime_error if the file cannot be written.
+	*/
+	static void write(const std::string& filename, const unsigned char* rgb, size_t width, size_t height, bool bottom_up = false)
+	{
+		std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+		if (!out) { throw std::runtime_error("Multiplot: cannot write " + filename); }
+		const size_t row = width * 3;
+		auto row_ptr = [&](size_t y) { return rgb + (bottom_up ? height - 1 - y : y) * row; };
 
-		if(!SetPixelFormat(hDC,PixelFormat,&pfd))		// Are We Able To Set The Pixel Format?
+		const bool png = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".png") == 0;
+		if (!png)
 		{
-			//KillGLWindow();								// Reset The Display
-			throw(std::exception("Can't Set The PixelFormat."));
+			out << "P6\n" << width << " " << height << "\n255\n";
+			for (size_t y = 0; y < height; y++) { out.write(reinterpret_cast<const char*>(row_ptr(y)), std::streamsize(row)); }
+			return;
 		}
 
-		if (!(hRC=wglCreateContext(hDC)))				// Are We Able To Get A Rendering Context?
+		// filtered image data: filter type byte + difference to the row above
+		std::vector<unsigned char> raw;
+		raw.reserve((row + 1) * height);
+		for (size_t y = 0; y < height; y++)
 		{
-			throw(std::exception("Can't Create A GL Rendering Context."));
+			const unsigned char* r = row_ptr(y);
+			raw.push_back(2); // up
+			for (size_t i = 0; i < row; i++) { raw.push_back(y > 0 ? (unsigned char)(r[i] - row_ptr(y - 1)[i]) : r[i]); }
 		}
 
-		if(!wglMakeCurrent(hDC,hRC))					// Try To Activate The Rendering Context
-		{
-			throw(std::exception("Can't Activate The GL Rendering Context."));
-		}
+		std::vector<unsigned char> header(13);
+		put32(&header[0], uint32_t(width));
+		put32(&header[4], uint32_t(height));
+		header[8] = 8;	// bits per channel
+		header[9] = 2;	// rgb
+		out.write("\x89PNG\r\n\x1a\n", 8);
+		chunk(out, "IHDR", header);
+		chunk(out, "IDAT", zlib(raw));
+		chunk(out, "IEND", std::vector<unsigned char>());
+	}
 
-		ShowWindow(hWnd,SW_SHOW);						// Show The Window
-		SetForegroundWindow(hWnd);						// Slightly Higher Priority
-		SetFocus(hWnd);									// Sets Keyboard Focus To The Window
-		//ReSizeGLScene(width, height);					// Set Up Our Perspective GL Screen
+protected:
+	static void put32(unsigned char* p, uint32_t v) { p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = (unsigned char)v; }
 
-		/*if (!InitGL())									// Initialize Our Newly Created GL Window
+	static uint32_t crc32(uint32_t crc, const unsigned char* p, size_t n)
+	{
+		static uint32_t table[256] = {};
+		if (!table[1])
 		{
-		KillGLWindow();								// Reset The Display
-		MessageBox(NULL,"Initialization Failed.","ERROR",MB_OK|MB_ICONEXCLAMATION);
-		return FALSE;								// Return FALSE
-		}*/
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t c = i;
+				for (int k = 0; k < 8; k++) { c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1; }
+				table[i] = c;
+			}
+		}
+		crc = ~crc;
+		for (size_t i = 0; i < n; i++) { crc = table[(crc ^ p[i]) & 255] ^ (crc >> 8); }
+		return ~crc;
+	}
 
-		return true;									// Success
+	static void chunk(std::ofstream& out, const char* type, const std::vector<unsigned char>& data)
+	{
+		unsigned char len[4];
+		put32(len, uint32_t(data.size()));
+		out.write(reinterpret_cast<const char*>(len), 4);
+		out.write(type, 4);
+		out.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+		uint32_t crc = crc32(0, reinterpret_cast<const unsigned char*>(type), 4);
+		crc = crc32(crc, data.data(), data.size());
+		unsigned char c[4];
+		put32(c, crc);
+		out.write(reinterpret_cast<const char*>(c), 4);
 	}
 
-	void DestroyGLWindow()
+	// writes bits to a deflate stream, least significant bit first
+	struct Bit_stream
 	{
-		// destroy the window and rendering context
-		if (fullscreen)										// Are We In Fullscreen Mode?
+		std::vector<unsigned char>& out;
+		uint32_t bits = 0;
+		int count = 0;
+		void put(uint32_t v, int n)
 		{
-			ChangeDisplaySettings(NULL,0);					// If So Switch Back To The Desktop
-			ShowCursor(TRUE);								// Show Mouse Pointer
+			bits |= v << count;
+			count += n;
+			while (count >= 8) { out.push_back((unsigned char)bits); bits >>= 8; count -= 8; }
 		}
+		// huffman codes are stored most significant bit first
+		void code(uint32_t c, int n) { uint32_t r = 0; for (int k = 0; k < n; k++) { r |= ((c >> k) & 1) << (n - 1 - k); } put(r, n); }
+		// a literal byte or a length code of the fixed huffman table
+		void symbol(uint32_t s)
+		{
+			if (s < 144) { code(0x30 + s, 8); }
+			else if (s < 256) { code(0x190 + s - 144, 9); }
+			else if (s < 280) { code(s - 256, 7); }
+			else { code(0xC0 + s - 280, 8); }
+		}
+		void flush() { if (count > 0) { out.push_back((unsigned char)bits); } bits = 0; count = 0; }
+	};
 
-		if (hRC)											// Do We Have A Rendering Context?
+	static std::vector<unsigned char> zlib(const std::vector<unsigned char>& data)
+	{
+		static const uint16_t base[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+		static const uint8_t extra[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+
+		std::vector<unsigned char> out = { 0x78, 0x01 };
+		Bit_stream bs{ out };
+		bs.put(1, 1); // final block
+		bs.put(1, 2); // fixed huffman codes
+		size_t i = 0;
+		while (i < data.size())
 		{
-			if (!wglMakeCurrent(NULL,NULL))					// Are We Able To Release The DC And RC Contexts?
+			// a run of bytes equal to the previous one is a match with distance 1
+			size_t run = 0;
+			while (i > 0 && i + run < data.size() && run < 258 && data[i + run] == data[i - 1]) { run++; }
+			if (run >= 3)
 			{
-				throw(std::exception("Release Of DC And RC Failed."));
+				int k = 28;
+				while (base[k] > run) { k--; }
+				bs.symbol(257 + k);
+				bs.put(uint32_t(run - base[k]), extra[k]);
+				bs.code(0, 5); // distance 1
+				i += run;
 			}
-
-			if (!wglDeleteContext(hRC))						// Are We Able To Delete The RC?
+			else
 			{
-				throw(std::exception("Release Rendering Context Failed."));
+				bs.symbol(data[i]);
+				i++;
 			}
-			hRC=NULL;										// Set RC To NULL
 		}
+		bs.symbol(256); // end of block
+		bs.flush();
+
+		uint32_t a = 1, b = 0;
+		for (unsigned char c : data) { a = (a + c) % 65521; b = (b + a) % 65521; }
+		unsigned char adler[4];
+		put32(adler, b << 16 | a);
+		out.insert(out.end(), adler, adler + 4);
+		return out;
+	}
+};
 
-		if (hDC && !ReleaseDC(hWnd,hDC))					// Are We Able To Release The DC
-		{
-			throw(std::exception("Release Device Context Failed."));
-			hDC=NULL;										// Set DC To NULL
-		}
 
-		if (hWnd && !DestroyWindow(hWnd))					// Are We Able To Destroy The Window?
-		{
-			throw(std::exception("Could Not Release hWnd."));
-			hWnd=NULL;										// Set hWnd To NULL
-		}
+//////////////////////////////////////////////////////////////////////////
+// frame metrics, see Multiplot::collect_metrics()
+
+/**
+* what went into one frame. times are in milliseconds. the phases follow each other
+* in this order: events (in check(), before the frame), ingest, bounds, grid, traces,
+* views, caption, swap.
+*/
+struct Frame_metrics
+{
+	unsigned long long frame = 0;	// number of the frame, counted since the metrics were enabled
+	double start_us = 0;			// start of the frame in microseconds since the metrics were enabled
+	double total_ms = 0;			// Multiplot::draw(), without the buffer swap
+	double events_ms = 0;			// event handling in check() since the last frame (with fltk this includes its buffer swap)
+	double ingest_ms = 0;			// taking over the samples of push()
+	double bounds_ms = 0;			// bounding boxes and scaling
+	double grid_ms = 0;				// grid and coordinate cross
+	std::vector<double> trace_ms;	// Trace::draw() of each trace
+	std::vector<double> view_ms;	// Trace_view::draw() of each view
+	double caption_ms = 0;			// drawing the labels and updating the window title
+	double swap_ms = 0;				// buffer swap (win32: including the event check of redraw())
+	size_t vertices = 0;			// vertices sent to opengl
+	size_t draw_calls = 0;			// glDrawArrays, glDrawElements and glBegin/glEnd blocks
+	size_t state_changes = 0;		// line width, point size, color and vertex array changes
+	size_t points = 0;				// points in all traces and views
+	size_t points_ingested = 0;		// points plotted since the last frame
+
+	double traces_ms() const { double t = 0; for (double d : trace_ms) { t += d; } for (double d : view_ms) { t += d; } return t; }
+
+	// points per vertex drawn. large if the traces were decimated
+	double decimation() const { return vertices ? double(points) / double(vertices) : 0.0; }
 
-		if (!UnregisterClass(L"OpenGL",hInstance))			// Are We Able To Unregister Class
+	/**
+	*	writes frames as chrome trace-event json, to be opened with chrome://tracing or
+	*	ui.perfetto.dev. each phase becomes a slice, the counts become counter tracks.
+	*/
+	static void write_trace(const std::string& filename, const std::vector<Frame_metrics>& frames)
+	{
+		std::ofstream f(filename);
+		if (!f) { throw std::runtime_error("Multiplot: cannot write " + filename); }
+		f.imbue(std::locale::classic());
+		f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool first = true;
+		auto slice = [&](const std::string& name, double ts_us, double ms)
 		{
-			throw(std::exception("Could Not Unregister Class."));
-			hInstance=NULL;									// Set hInstance To NULL
+			f << (first ? "" : ",\n") << "{\"name\":\"" << name << "\",\"cat\":\"multiplot\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << ts_us << ",\"dur\":" << 1000.0 * ms << "}";
+			first = false;
+		};
+		for (const Frame_metrics& m : frames)
+		{
+			if (m.events_ms > 0) { slice("events", m.start_us - 1000.0 * m.events_ms, m.events_ms); }
+			slice("frame " + std::to_string(m.frame), m.start_us, m.total_ms + m.swap_ms);
+			double t = m.start_us;
+			auto phase = [&](const std::string& name, double ms) { if (ms > 0) { slice(name, t, ms); } t += 1000.0 * ms; };
+			phase("ingest", m.ingest_ms);
+			phase("bounds", m.bounds_ms);
+			phase("grid", m.grid_ms);
+			for (size_t i = 0; i < m.trace_ms.size(); i++) { phase("trace " + std::to_string(i), m.trace_ms[i]); }
+			for (size_t i = 0; i < m.view_ms.size(); i++) { phase("view " + std::to_string(i), m.view_ms[i]); }
+			phase("caption", m.caption_ms);
+			if (m.swap_ms > 0) { slice("swap", m.start_us + 1000.0 * m.total_ms, m.swap_ms); }
+			f << ",\n{\"name\":\"counts\",\"ph\":\"C\",\"pid\":1,\"ts\":" << m.start_us << ",\"args\":{\"vertices\":" << m.vertices
+				<< ",\"draw_calls\":" << m.draw_calls << ",\"state_changes\":" << m.state_changes << ",\"points_ingested\":" << m.points_ingested << "}}";
 		}
+		f << "\n]}\n";
 	}
+};
 
-	static LRESULT CALLBACK window_handler(	HWND	hWnd,			// Handle For This Window
-		UINT	uMsg,			// Message For This Window
-		WPARAM	wParam,			// Additional Message Information
-		LPARAM	lParam)			// Additional Message Information
-	{
-		switch (uMsg)									// Check For Windows Messages
-		{
-		case WM_ACTIVATE:							// Watch For Window Activate Message
-			{
-				if (!HIWORD(wParam))					// Check Minimization State
-				{
-					//active=TRUE;						// Program Is Active
-				}
-				else
-				{
-					//active=FALSE;						// Program Is No Longer Active
-				}
 
-				return 0;								// Return To The Message Loop
-			}
+#ifdef MULTIPLOT_SOFTWARE
 
-		case WM_SYSCOMMAND:							// Intercept System Commands
-			{
-				switch (wParam)							// Check System Calls
-				{
-				case SC_SCREENSAVE:					// Screensaver Trying To Start?
-				case SC_MONITORPOWER:				// Monitor Trying To Enter Powersave?
-					return 0;							// Prevent From Happening
-				}
-				break;									// Exit
-			}
+//////////////////////////////////////////////////////////////////////////
+// software rendering without opengl. class Raster draws lines and points into a frame
+// buffer in main memory. the few opengl 1.1 functions that multiplot uses are defined
+// below on top of it, so the drawing code is the same for all backends.
+
+typedef unsigned int GLenum;
+typedef unsigned int GLbitfield;
+typedef unsigned int GLuint;
+typedef int GLint;
+typedef int GLsizei;
+typedef float GLfloat;
+typedef float GLclampf;
+typedef double GLdouble;
+typedef unsigned char GLubyte;
+
+#ifndef GL_POINTS
+#define GL_POINTS				0x0000
+#define GL_LINES				0x0001
+#define GL_LINE_STRIP			0x0003
+#define GL_UNSIGNED_BYTE		0x1401
+#define GL_UNSIGNED_INT			0x1405
+#define GL_FLOAT				0x1406
+#define GL_DEPTH_BUFFER_BIT		0x00000100
+#define GL_COLOR_BUFFER_BIT		0x00004000
+#define GL_BACK					0x0405
+#define GL_LIGHTING				0x0B50
+#define GL_DEPTH_TEST			0x0B71
+#define GL_DRAW_BUFFER			0x0C01
+#define GL_PACK_ALIGNMENT		0x0D05
+#define GL_MODELVIEW			0x1700
+#define GL_PROJECTION			0x1701
+#define GL_RGB					0x1907
+#define GL_SMOOTH				0x1D01
+#define GL_VERSION				0x1F02
+#define GL_VERTEX_ARRAY			0x8074
+#define GL_COLOR_ARRAY			0x8076
+#endif
 
-		case WM_CLOSE:								// Did We Receive A Close Message?
-			{
-				PostQuitMessage(0);						// Send A Quit Message
-				return 0;								// Jump Back
-			}
+/**
+* a frame buffer in main memory with a rasterizer for lines and points.
+* the primitives of a frame are collected in window coordinates and drawn by render():
+* the frame is cut into horizontal bands that are filled by several threads. each band
+* walks through all primitives in drawing order, so the picture does not depend on the
+* number of threads. the rules follow aliased opengl: a line of width w covers w pixels
+* across its minor axis, a point of size s is a square of s x s pixels, and the colors
+* are interpolated along the lines.
+*/
+class Raster
+{
+public:
+	struct Vertex { float x, y, r, g, b; };	// window coordinates, color 0..255
 
-		case WM_KEYDOWN:							// Is A Key Being Held Down?
-			{
-				//keys[wParam] = TRUE;					// If So, Mark It As TRUE
-				return 0;								// Jump Back
-			}
+	unsigned int width = 0;
+	unsigned int height = 0;
+	std::vector<uint32_t> pixels;	// r,g,b,a bytes per pixel, the bottom row first (like opengl)
 
-		case WM_KEYUP:								// Has A Key Been Released?
-			{
-				//keys[wParam] = FALSE;					// If So, Mark It As FALSE
-				return 0;								// Jump Back
-			}
+	void resize(unsigned int w, unsigned int h) { width = w; height = h; pixels.assign(size_t(w) * h, pack(0, 0, 0)); }
 
-		case WM_SIZE:								// Resize The OpenGL Window
+	/**
+	*	the raster that the gl functions below draw into. like a current opengl context,
+	*	it is set per thread (see Multiplot_base::make_current()).
+	*/
+	static Raster*& current() { static thread_local Raster* r = nullptr; return r; }
+
+	/**
+	*	rasterizes the primitives collected since the last call into pixels.
+	*/
+	void render()
+	{
+		if (pixels.size() != size_t(width) * height) { pixels.assign(size_t(width) * height, pack(0, 0, 0)); }
+		// small frames are not worth starting threads
+		const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+		const unsigned int bands = vertices.size() < 4096 ? 1u : std::min(cores, std::max(1u, height / 16));
+		const unsigned int band_height = (height + bands - 1) / bands;
+		auto band = [this, band_height](unsigned int k) { draw_band(int(k * band_height), int(std::min(height, (k + 1) * band_height))); };
+		std::vector<std::thread> threads;
+		for (unsigned int k = 1; k < bands; k++) { threads.emplace_back(band, k); }
+		band(0);
+		for (std::thread& t : threads) { t.join(); }
+		primitives.clear();
+		vertices.clear();
+		clear_pending = false;
+	}
+
+	/**
+	*	copies a rectangle of the frame buffer as rgb bytes, the bottom row first.
+	*/
+	void read(int x, int y, int w, int h, unsigned char* rgb) const
+	{
+		for (int j = 0; j < h; j++)
+		{
+			for (int i = 0; i < w; i++, rgb += 3)
 			{
-				LPARAM x = lParam;
-				int xx = LOWORD(lParam);
-				//((Multiplot*)x)->width =x;
-				// todo... problem with member function pointer
-				/*((Multiplot*)wParam)->width = LOWORD(lParam); // LoWord=Width, HiWord=Height
-				((Multiplot*)wParam)->height = HIWORD(lParam);
-				((Multiplot*)wParam)->initgl();*/
-				return 0;								// Jump Back
+				const int px = x + i, py = y + j;
+				const uint32_t c = (px >= 0 && py >= 0 && px < int(width) && py < int(height)) ? pixels[size_t(py) * width + px] : 0;
+				rgb[0] = (unsigned char)(c); rgb[1] = (unsigned char)(c >> 8); rgb[2] = (unsigned char)(c >> 16);
 			}
 		}
-
-		// Pass All Unhandled Messages To DefWindowProc
-		return DefWindowProc(hWnd,uMsg,wParam,lParam);
 	}
 
-
-	
-public:
-	virtual ~Multiplot_base(){ DestroyGLWindow(); }
+	// the opengl state used by the functions below
+	struct Affine { float sx = 1, sy = 1, tx = 0, ty = 0; };
+	struct Gl_state
+	{
+		float color[3] = { 1, 1, 1 };
+		float clear_color[3] = { 0, 0, 0 };
+		float line_width = 1, point_size = 1;
+		GLenum matrix_mode = GL_MODELVIEW;
+		std::vector<Affine> modelview{ Affine() }, projection{ Affine() };
+		int viewport[4] = { 0, 0, 0, 0 };
+		bool vertex_array = false, color_array = false;
+		const char* vertex_pointer = nullptr;
+		const char* color_pointer = nullptr;
+		size_t vertex_stride = 0, color_stride = 0;
+		GLenum begin_mode = GL_POINTS;
+		size_t begin_first = 0;
+		std::vector<Affine>& matrix() { return GL_PROJECTION == matrix_mode ? projection : modelview; }
+	} gl;
 
 	/**
-	*	this constructor tells multiplot where to put the window on the 
-	*	desktop in pixel-coordinates(x,y) and with wich width and height (w,h)
+	*	outer(inner(v)) as a single transformation.
 	*/
-	Multiplot_base(int x, int y, int w, int h, const std::wstring& ttitle, bool fullscreen)
-	{ 
-		hDC=NULL;
-		CreateGLWindow(x, y, w, h, ttitle, 32, fullscreen);
+	static Affine combine(const Affine& outer, const Affine& inner)
+	{
+		Affine a;
+		a.sx = outer.sx * inner.sx; a.tx = outer.sx * inner.tx + outer.tx;
+		a.sy = outer.sy * inner.sy; a.ty = outer.sy * inner.ty + outer.ty;
+		return a;
 	}
 
 	/**
-	*	call show() to make the window visible
-	*	only needed if using FLTK as window-creation backend.
+	*	maps object coordinates to window coordinates: viewport(projection(modelview(v))).
 	*/
-	void show()
+	Affine window_transform() const
 	{
+		Affine v;
+		v.sx = 0.5f * gl.viewport[2]; v.tx = gl.viewport[0] + v.sx;
+		v.sy = 0.5f * gl.viewport[3]; v.ty = gl.viewport[1] + v.sy;
+		return combine(v, combine(gl.projection.back(), gl.modelview.back()));
 	}
-	
-	void hide()
+
+	void clear()
+	{
+		primitives.clear();
+		vertices.clear();
+		clear_color = pack(255 * gl.clear_color[0], 255 * gl.clear_color[1], 255 * gl.clear_color[2]);
+		clear_pending = true;
+	}
+
+	void begin(GLenum mode) { gl.begin_mode = mode; gl.begin_first = vertices.size(); }
+
+	void vertex(float x, float y)
 	{
+		const Affine m = window_transform();
+		vertices.push_back(Vertex{ snap(m.sx * x + m.tx), snap(m.sy * y + m.ty), 255 * gl.color[0], 255 * gl.color[1], 255 * gl.color[2] });
 	}
 
 	/**
-	*	propagate window events
-	*	returns false if ESC was pressed, true otherwise
+	*	appends count vertices of the client side arrays, index(i) is the array index of vertex i.
 	*/
-	bool check()
+	template<class I> void vertices_from_arrays(GLenum mode, const I& index, size_t count)
 	{
-		MSG msg;
-		bool ok=true;
-
-		if (GetAsyncKeyState(VK_ESCAPE) & 0x8000) { ok = false; }
-
-		// now, check any messages, so win32 is happy
-		if(PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))//GetMessage( &msg, NULL, 0, 0 ) )
+		if (!gl.vertex_array || !gl.vertex_pointer || 0 == count) { return; }
+		const Affine m = window_transform();
+		const size_t first = vertices.size();
+		vertices.resize(first + count);
+		Vertex* out = &vertices[first];
+		for (size_t i = 0; i < count; i++)
 		{
-			TranslateMessage(&msg); 
-			DispatchMessage(&msg); 
+			const float* p = (const float*)(gl.vertex_pointer + index(i) * gl.vertex_stride);
+			out[i].x = snap(m.sx * p[0] + m.tx);
+			out[i].y = snap(m.sy * p[1] + m.ty);
+		}
+		if (gl.color_array && gl.color_pointer)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				const float* c = (const float*)(gl.color_pointer + index(i) * gl.color_stride);
+				out[i].r = 255 * c[0]; out[i].g = 255 * c[1]; out[i].b = 255 * c[2];
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < count; i++) { out[i].r = 255 * gl.color[0]; out[i].g = 255 * gl.color[1]; out[i].b = 255 * gl.color[2]; }
 		}
+		primitive(mode, first);
+	}
 
-		return ok;
+	/**
+	*	turns the vertices from first to the end into a primitive.
+	*/
+	void primitive(GLenum mode, size_t first)
+	{
+		if (first >= vertices.size()) { return; }
+		Primitive p;
+		p.mode = mode;
+		p.first = first;
+		p.count = vertices.size() - first;
+		p.size = GL_POINTS == mode ? gl.point_size : gl.line_width;
+		p.y_min = p.y_max = vertices[first].y;
+		for (size_t i = first; i < vertices.size(); i++)
+		{
+			p.y_min = std::min(p.y_min, vertices[i].y);
+			p.y_max = std::max(p.y_max, vertices[i].y);
+		}
+		primitives.push_back(p);
 	}
 
-	unsigned int w() { return width; }
-	unsigned int h() { return height; }
-	bool valid() { return valid_; }
-	void valid(bool v) { valid_=v; }
+protected:
+	struct Primitive
+	{
+		GLenum mode;
+		size_t first, count;
+		float size;			// line width or point size
+		float y_min, y_max;	// to skip the primitive in bands it does not touch
+	};
+	std::vector<Primitive> primitives;
+	std::vector<Vertex> vertices;
+	uint32_t clear_color = 0;
+	bool clear_pending = false;
 
-	virtual void draw()
+	static uint32_t pack(float r, float g, float b)
 	{
+		return uint32_t(r + 0.5f) | uint32_t(g + 0.5f) << 8 | uint32_t(b + 0.5f) << 16 | 0xff000000u;
 	}
 
-	void caption(const std::wstring& t)
-	{
-		title_str = t;
-		SetWindowText(hWnd, title_str.c_str());
+	// window coordinates have 8 subpixel bits, like in opengl implementations. so a line at
+	// x = 160.00001 lands on the same pixels as one at x = 160
+	static float snap(float v) { return std::floor(v * 256.0f + 0.5f) * (1.0f / 256.0f); }
+
+	// float to int, limited to [lo, hi]. also safe for coordinates far outside the window
+	static int clamp(float v, int lo, int hi) { return !(v > float(lo)) ? lo : (v < float(hi) ? int(v) : hi); }
+
+	void draw_band(int lo, int hi)
+	{
+		if (lo >= hi) { return; }
+		if (clear_pending) { std::fill(pixels.begin() + size_t(lo) * width, pixels.begin() + size_t(hi) * width, clear_color); }
+		for (const Primitive& p : primitives)
+		{
+			if (p.y_max < lo - p.size || p.y_min > hi + p.size) { continue; }
+			const Vertex* v = &vertices[p.first];
+			switch (p.mode)
+			{
+			case GL_POINTS:		for (size_t i = 0; i < p.count; i++) { point(v[i], p.size, lo, hi); } break;
+			case GL_LINES:		for (size_t i = 0; i + 1 < p.count; i += 2) { line(v[i], v[i + 1], p.size, lo, hi); } break;
+			case GL_LINE_STRIP:	for (size_t i = 0; i + 1 < p.count; i++) { line(v[i], v[i + 1], p.size, lo, hi); } break;
+			}
+		}
 	}
 
-	/**
-	* call redraw to refresh the window and to redraw all traces.
-	*/
-	void redraw() 
+	void point(const Vertex& v, float size, int lo, int hi)
 	{
-		draw(); 
-		check();
-		SwapBuffers(hDC);
+		const int s = std::max(1, int(size + 0.5f));
+		const float x0 = std::floor(v.x + 0.5f - 0.5f * s), y0 = std::floor(v.y + 0.5f - 0.5f * s);
+		const int ia = clamp(x0, 0, int(width)), ib = clamp(x0 + s, 0, int(width));
+		const int ja = clamp(y0, lo, hi), jb = clamp(y0 + s, lo, hi);
+		if (ia >= ib) { return; }
+		const uint32_t c = pack(v.r, v.g, v.b);
+		for (int j = ja; j < jb; j++) { std::fill_n(&pixels[size_t(j) * width + ia], ib - ia, c); }
 	}
-};
 
-#endif
+	void line(const Vertex& a, const Vertex& b, float size, int lo, int hi)
+	{
+		const int w = std::max(1, int(size + 0.5f));
+		if (std::min(a.y, b.y) > hi + w || std::max(a.y, b.y) < lo - w) { return; }
+		const bool x_major = std::fabs(b.x - a.x) >= std::fabs(b.y - a.y);
+		const Vertex& p = (x_major ? a.x <= b.x : a.y <= b.y) ? a : b;	// p is the start on the major axis
+		const Vertex& q = &p == &a ? b : a;
+		const bool flat = p.r == q.r && p.g == q.g && p.b == q.b;
+		const uint32_t flat_color = pack(p.r, p.g, p.b);
+
+		if (x_major)
+		{
+			// one vertical run of w pixels for each pixel column whose center is covered
+			const int i0 = clamp(std::ceil(p.x - 0.5f), 0, int(width));
+			const int i1 = clamp(std::ceil(q.x - 0.5f), 0, int(width));
+			if (i0 >= i1) { return; }
+			const float inv = 1.0f / (q.x - p.x);
+			for (int i = i0; i < i1; i++)
+			{
+				const float t = (i + 0.5f - p.x) * inv;
+				const int j0 = clamp(std::ceil(p.y + t * (q.y - p.y) - 0.5f - 0.5f * w), lo - w, hi);
+				const int ja = std::max(j0, lo), jb = std::min(j0 + w, hi);
+				if (ja >= jb) { continue; }
+				const uint32_t c = flat ? flat_color : pack(p.r + t * (q.r - p.r), p.g + t * (q.g - p.g), p.b + t * (q.b - p.b));
+				uint32_t* px = &pixels[size_t(ja) * width + i];
+				for (int j = ja; j < jb; j++, px += width) { *px = c; }
+			}
+		}
+		else
+		{
+			// one horizontal run of w pixels for each row, only the rows of this band
+			const int j0 = clamp(std::ceil(p.y - 0.5f), lo, hi);
+			const int j1 = clamp(std::ceil(q.y - 0.5f), lo, hi);
+			if (j0 >= j1) { return; }
+			const float inv = 1.0f / (q.y - p.y);
+			for (int j = j0; j < j1; j++)
+			{
+				const float t = (j + 0.5f - p.y) * inv;
+				const float x = std::ceil(p.x + t * (q.x - p.x) - 0.5f - 0.5f * w);
+				const int ia = clamp(x, 0, int(width)), ib = clamp(x + w, 0, int(width));
+				if (ia >= ib) { continue; }
+				const uint32_t c = flat ? flat_color : pack(p.r + t * (q.r - p.r), p.g + t * (q.g - p.g), p.b + t * (q.b - p.b));
+				std::fill_n(&pixels[size_t(j) * width + ia], ib - ia, c);
+			}
+		}
+	}
+};
 
-/**
- *	this class creates a window to wich you can add an arbitrary number of 
- *	autoscaling traces.
- */
-class Multiplot : public Multiplot_base
+// the opengl 1.1 subset used by multiplot, drawing into Raster::current()
+
+inline const GLubyte* glGetString(GLenum name) { return (const GLubyte*)(GL_VERSION == name ? "1.1 multiplot software rasterizer" : ""); }
+inline void glViewport(GLint x, GLint y, GLsizei w, GLsizei h) { if (Raster* r = Raster::current()) { r->gl.viewport[0] = x; r->gl.viewport[1] = y; r->gl.viewport[2] = w; r->gl.viewport[3] = h; } }
+inline void glMatrixMode(GLenum mode) { if (Raster* r = Raster::current()) { r->gl.matrix_mode = mode; } }
+inline void glLoadIdentity() { if (Raster* r = Raster::current()) { r->gl.matrix().back() = Raster::Affine(); } }
+inline void glPushMatrix() { if (Raster* r = Raster::current()) { r->gl.matrix().push_back(r->gl.matrix().back()); } }
+inline void glPopMatrix() { if (Raster* r = Raster::current()) { if (r->gl.matrix().size() > 1) { r->gl.matrix().pop_back(); } } }
+inline void glScalef(GLfloat x, GLfloat y, GLfloat) { if (Raster* r = Raster::current()) { Raster::Affine a; a.sx = x; a.sy = y; r->gl.matrix().back() = Raster::combine(r->gl.matrix().back(), a); } }
+inline void glTranslatef(GLfloat x, GLfloat y, GLfloat) { if (Raster* r = Raster::current()) { Raster::Affine a; a.tx = x; a.ty = y; r->gl.matrix().back() = Raster::combine(r->gl.matrix().back(), a); } }
+inline void glOrtho(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top, GLdouble, GLdouble)
 {
-protected:
-	class Color3f
+	if (Raster* r = Raster::current())
 	{
-	public:
-		float r = 0.0f;
-		float g = 0.0f;
-		float b = 0.0f;
-		Color3f(float r_, float g_, float b_) { r = r_; g = g_; b = b_; }
-	};
+		Raster::Affine a;
+		a.sx = float(2 / (right - left)); a.tx = float(-(right + left) / (right - left));
+		a.sy = float(2 / (top - bottom)); a.ty = float(-(top + bottom) / (top - bottom));
+		r->gl.matrix().back() = Raster::combine(r->gl.matrix().back(), a);
+	}
+}
+inline void glColor3f(GLfloat red, GLfloat green, GLfloat blue) { if (Raster* r = Raster::current()) { r->gl.color[0] = red; r->gl.color[1] = green; r->gl.color[2] = blue; } }
+inline void glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf) { if (Raster* r = Raster::current()) { r->gl.clear_color[0] = red; r->gl.clear_color[1] = green; r->gl.clear_color[2] = blue; } }
+inline void glClear(GLbitfield mask) { if (Raster* r = Raster::current()) { if (mask & GL_COLOR_BUFFER_BIT) { r->clear(); } } }
+inline void glLineWidth(GLfloat w) { if (Raster* r = Raster::current()) { if (w > 0) { r->gl.line_width = w; } } }
+inline void glPointSize(GLfloat s) { if (Raster* r = Raster::current()) { if (s > 0) { r->gl.point_size = s; } } }
+inline void glBegin(GLenum mode) { if (Raster* r = Raster::current()) { r->begin(mode); } }
+inline void glVertex2f(GLfloat x, GLfloat y) { if (Raster* r = Raster::current()) { r->vertex(x, y); } }
+inline void glEnd() { if (Raster* r = Raster::current()) { r->primitive(r->gl.begin_mode, r->gl.begin_first); } }
+inline void glEnableClientState(GLenum a) { if (Raster* r = Raster::current()) { if (GL_VERTEX_ARRAY == a) { r->gl.vertex_array = true; } if (GL_COLOR_ARRAY == a) { r->gl.color_array = true; } } }
+inline void glDisableClientState(GLenum a) { if (Raster* r = Raster::current()) { if (GL_VERTEX_ARRAY == a) { r->gl.vertex_array = false; } if (GL_COLOR_ARRAY == a) { r->gl.color_array = false; } } }
+inline void glVertexPointer(GLint, GLenum, GLsizei stride, const void* p) { if (Raster* r = Raster::current()) { r->gl.vertex_pointer = (const char*)p; r->gl.vertex_stride = stride ? stride : 2 * sizeof(float); } }
+inline void glColorPointer(GLint, GLenum, GLsizei stride, const void* p) { if (Raster* r = Raster::current()) { r->gl.color_pointer = (const char*)p; r->gl.color_stride = stride ? stride : 3 * sizeof(float); } }
+inline void glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	if (Raster* r = Raster::current()) { if (count > 0) { r->vertices_from_arrays(mode, [first](size_t i) { return size_t(first) + i; }, size_t(count)); } }
+}
+inline void glDrawElements(GLenum mode, GLsizei count, GLenum, const void* indices)
+{
+	const GLuint* index = (const GLuint*)indices;
+	if (Raster* r = Raster::current()) { if (count > 0) { r->vertices_from_arrays(mode, [index](size_t i) { return size_t(index[i]); }, size_t(count)); } }
+}
+inline void glFinish() { if (Raster* r = Raster::current()) { r->render(); } }
+inline void glReadPixels(GLint x, GLint y, GLsizei w, GLsizei h, GLenum, GLenum, void* rgb) { if (Raster* r = Raster::current()) { r->read(x, y, w, h, (unsigned char*)rgb); } }
+inline void glGetIntegerv(GLenum, GLint*) {}
+inline void glReadBuffer(GLenum) {}
+inline void glPixelStorei(GLenum, GLint) {}
+inline void glDisable(GLenum) {}
+inline void glShadeModel(GLenum) {}
+// there are no buffer objects, Gl_buffers::available() is false and the traces use client side arrays
+inline void glGenBuffers(GLsizei n, GLuint* ids) { for (GLsizei i = 0; i < n; i++) { ids[i] = 0; } }
+inline void glDeleteBuffers(GLsizei, const GLuint*) {}
+inline void glBindBuffer(GLenum, GLuint) {}
+inline void glBufferData(GLenum, ptrdiff_t, const void*, GLenum) {}
+inline void glBufferSubData(GLenum, ptrdiff_t, ptrdiff_t, const void*) {}
 
-	class Point2d
+#endif
+
+
+//////////////////////////////////////////////////////////////////////////
+// opengl 1.5 buffer objects. the traces keep their vertices in these buffers, so a
+// redraw only needs a handful of draw calls instead of one glVertex call per point.
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_DYNAMIC_DRAW
+#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+class Gl_buffers
+{
+public:
+	/**
+	*	returns true if the current opengl context supports buffer objects.
+	*	needs a current context the first time it is called.
+	*	if false, the traces are drawn from client side vertex arrays (opengl 1.1).
+	*/
+	static bool available()
 	{
-	public:
-		float x = 0.0f;
-		float y = 0.0f;
-		float r = 1.0f;
-		float g = 1.0f;
-		float b = 1.0f;
-		float point_size = 0.0f;
-		float line_width = 1.0f; // width of the line from this point to the next point
-		
-		Point2d() {}
-		Point2d(float xx, float yy, float rr=1, float gg=1, float bb=1, float _lwidth=1.0, float _point_size=0.0)
+		static int state = -1; // -1 = not yet checked
+		if (state < 0)
 		{
-			x=xx;y=yy;
-			r=rr;g=gg;b=bb;
-			point_size=_point_size;
-			line_width=_lwidth;
+			const char* version = (const char*)glGetString(GL_VERSION);
+			if (!version) { return false; } // no context yet, try again later
+			int major = 0, minor = 0;
+			for (; *version >= '0' && *version <= '9'; version++) { major = 10 * major + (*version - '0'); }
+			if (*version == '.') { version++; }
+			for (; *version >= '0' && *version <= '9'; version++) { minor = 10 * minor + (*version - '0'); }
+			state = (major > 1 || (major == 1 && minor >= 5)) ? 1 : 0;
+			#ifdef _WIN32
+			if (state && !load()) { state = 0; }
+			#endif
 		}
+		return state == 1;
+	}
+
+	#ifdef _WIN32
+	static void gen(GLuint* id) { api().gen(1, id); }
+	static void destroy(GLuint* id) { api().del(1, id); }
+	static void bind(GLuint id) { api().bind(GL_ARRAY_BUFFER, id); }
+	static void data(size_t bytes, const void* p, GLenum usage) { api().data(GL_ARRAY_BUFFER, (ptrdiff_t)bytes, p, usage); }
+	static void sub_data(size_t offset, size_t bytes, const void* p) { api().sub_data(GL_ARRAY_BUFFER, (ptrdiff_t)offset, (ptrdiff_t)bytes, p); }
+	#else
+	static void gen(GLuint* id) { glGenBuffers(1, id); }
+	static void destroy(GLuint* id) { glDeleteBuffers(1, id); }
+	static void bind(GLuint id) { glBindBuffer(GL_ARRAY_BUFFER, id); }
+	static void data(size_t bytes, const void* p, GLenum usage) { glBufferData(GL_ARRAY_BUFFER, bytes, p, usage); }
+	static void sub_data(size_t offset, size_t bytes, const void* p) { glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, p); }
+	#endif
+
+private:
+	#ifdef _WIN32
+	struct Api
+	{
+		void (APIENTRY *gen)(GLsizei, GLuint*) = nullptr;
+		void (APIENTRY *del)(GLsizei, const GLuint*) = nullptr;
+		void (APIENTRY *bind)(GLenum, GLuint) = nullptr;
+		void (APIENTRY *data)(GLenum, ptrdiff_t, const void*, GLenum) = nullptr;
+		void (APIENTRY *sub_data)(GLenum, ptrdiff_t, ptrdiff_t, const void*) = nullptr;
 	};
+	static Api& api() { static Api a; return a; }
+
+	static bool load()
+	{
+		Api& a = api();
+		a.gen      = (decltype(a.gen))     wglGetProcAddress("glGenBuffers");
+		a.del      = (decltype(a.del))     wglGetProcAddress("glDeleteBuffers");
+		a.bind     = (decltype(a.bind))    wglGetProcAddress("glBindBuffer");
+		a.data     = (decltype(a.data))    wglGetProcAddress("glBufferData");
+		a.sub_data = (decltype(a.sub_data))wglGetProcAddress("glBufferSubData");
+		return a.gen && a.del && a.bind && a.data && a.sub_data;
+	}
+	#endif
+};
 
+/**
+* a vertex buffer object that mirrors the points of a trace on the graphics card.
+* the buffer is allocated with some headroom and only the ranges that have been
+* written since the last draw are uploaded again (appended points or the slots
+* that were overwritten in a ringbuffer).
+* copies of a buffer start out empty and upload their data on the next draw, so
+* traces can still be copied around like any std::vector.
+* the buffer is only freed by release(), with the context of its window current
+* (see Multiplot::release_buffers()), never by the destructor.
+*/
+class Vertex_buffer
+{
 public:
-		// class Trace describes a single trace
-		// if scroll=true it works as a ringbuffer.
-		// the ringbuffer is filled till max_points.
-		// pos stores the actual read/write position in the ringbuffer
+	GLuint id = 0;
+	size_t capacity = 0;		// allocated size in bytes
+	bool modified = true;		// true if the whole gpu copy is out of date
+
+	Vertex_buffer() {}
+	Vertex_buffer(const Vertex_buffer&) {}
+	Vertex_buffer(Vertex_buffer&& o) noexcept : id(o.id), capacity(o.capacity), modified(o.modified), dirty_count(o.dirty_count) { dirty[0] = o.dirty[0]; dirty[1] = o.dirty[1]; o.id = 0; o.capacity = 0; }
+	Vertex_buffer& operator=(const Vertex_buffer&) { modified = true; return *this; }
+	// keeps a buffer of its own, which only release() frees, and takes the one of o otherwise
+	Vertex_buffer& operator=(Vertex_buffer&& o) noexcept
+	{
+		if (0 == id) { id = o.id; capacity = o.capacity; o.id = 0; o.capacity = 0; }
+		modified = true;
+		return *this;
+	}
 
-		/**
-		* class Trace describes a single Trace. A Multiplot-Window can
-		* contain an unlimited number of Traces.
-		*/
-		class Trace : public std::vector<Point2d>
+	/**
+	*	marks the bytes [first, last) as written. up to two separate ranges are
+	*	remembered, so a ringbuffer that wrapped around since the last draw still
+	*	uploads only the new data at its end and at its beginning.
+	*/
+	void modified_range(size_t first, size_t last)
+	{
+		if (modified) { return; }
+		for (size_t a = 0; a < dirty_count; a++)
 		{
-		public:
-			unsigned int max_points_to_plot = std::numeric_limits<unsigned int>::max();
-			MP_SCROLLING scroll = MP_NO_SCROLL;
-			size_t pos = 0; // current position in the ringbuffer
-			float cur_col[3]{ 1.0f, 1.0f, 1.0f };
-			float cur_line_width = 1.0f;
-			float cur_point_size = 0.0f;
+			if (first <= dirty[a].last && last >= dirty[a].first) // overlapping or adjacent
+			{
+				dirty[a].first = std::min(dirty[a].first, first);
+				dirty[a].last  = std::max(dirty[a].last, last);
+				return;
+			}
+		}
+		if (dirty_count < 2) { dirty[dirty_count++] = Range{ first, last }; return; }
+
+		// no free slot: grow the range that is closer to the new one
+		size_t gap0 = first > dirty[0].last ? first - dirty[0].last : dirty[0].first - last;
+		size_t gap1 = first > dirty[1].last ? first - dirty[1].last : dirty[1].first - last;
+		Range& r = gap0 <= gap1 ? dirty[0] : dirty[1];
+		r.first = std::min(r.first, first);
+		r.last  = std::max(r.last, last);
+	}
 
-			void draw(Point2d& minimum, Point2d& maximum, const Point2d& scale, const Point2d& offset)
+	/**
+	*	uploads the modified data and binds the buffer.
+	*	returns the base pointer for gl*Pointer calls: zero if the buffer
+	*	is used, or the client side data if buffer objects are not available.
+	*/
+	const char* bind(const void* data, size_t bytes)
+	{
+		if (!Gl_buffers::available()) { return (const char*)data; }
+		if (0 == id) { Gl_buffers::gen(&id); capacity = 0; modified = true; }
+		Gl_buffers::bind(id);
+		if (bytes > capacity)
+		{
+			// reserve headroom, so appending points does not reallocate every frame
+			capacity = std::max(bytes, 2 * capacity);
+			Gl_buffers::data(capacity, nullptr, GL_DYNAMIC_DRAW);
+			modified = true;
+		}
+		if (modified)
+		{
+			if (bytes > 0) { Gl_buffers::sub_data(0, bytes, data); }
+		}
+		else
+		{
+			for (size_t a = 0; a < dirty_count; a++)
 			{
-				if (size() == 0) { return; }
+				size_t last = std::min(dirty[a].last, bytes);
+				if (dirty[a].first < last) { Gl_buffers::sub_data(dirty[a].first, last - dirty[a].first, (const char*)data + dirty[a].first); }
+			}
+		}
+		modified = false;
+		dirty_count = 0;
+		return nullptr;
+	}
 
-				Point2d p,p1,p2;
-				Point2d trace_min, trace_max;
-				trace_min.x = std::numeric_limits<float>::max();
-				trace_min.y = std::numeric_limits<float>::max();
-				trace_max.x = std::numeric_limits<float>::min();
-				trace_max.y = std::numeric_limits<float>::min();
+	static void unbind() { if (Gl_buffers::available()) { Gl_buffers::bind(0); } }
 
-				size_t start=0;
-				if (MP_SCROLL_LEFT == scroll)
-				{
-					start = pos;
-				}
+	/**
+	*	frees the buffer on the graphics card. the gl context must be current.
+	*	use context_alive = false if the context has already been destroyed.
+	*/
+	void release(bool context_alive = true)
+	{
+		if (id && context_alive) { Gl_buffers::destroy(&id); }
+		id = 0;
+		capacity = 0;
+		modified = true;
+	}
 
-				// draw the lines of the trace
-				float line_width = at(start % size()).line_width;
-				glLineWidth(line_width);
-				glBegin(GL_LINES);
-				for(size_t a = start; a < start + size() - 1; a++)
-				{
-					if ((a + 1) == pos) { continue; } // in MP_SCROLL_WARP mode, skip this GL_LINE
-					
-					p1=(*this)[a % size()];
-					p2=(*this)[(a+1) % size()];
+protected:
+	struct Range { size_t first, last; };
+	Range dirty[2]{ { 0, 0 }, { 0, 0 } };
+	size_t dirty_count = 0;
+};
 
-					// TODO: if distance between two points is smaller than a pixel, then 
-					// skip and interpolate till we have at least a line with length=1pixel
 
-					if(p1.line_width > 0)
-					{
+//////////////////////////////////////////////////////////////////////////
+// text. the glyphs of a small built-in 5x7 pixel font are kept in one texture (the atlas),
+// so all strings of a frame are drawn as textured quads with a single draw call.
 
-						// reduce number of opengl state changes. so begin a new GL_LINES block
-						// only if line_width has changed.
-						if(p1.line_width != line_width)
-						{
-							glEnd();
-							line_width = p1.line_width;
-							glLineWidth(line_width);
-							glBegin(GL_LINES);
-						}
-						glColor3f(p1.r,p1.g,p1.b);
-						glVertex2f((p1.x-offset.x)*scale.x,(p1.y-offset.y)*scale.y);
-						glColor3f(p2.r,p2.g,p2.b);
-						glVertex2f((p2.x-offset.x)*scale.x,(p2.y-offset.y)*scale.y);
-					}
+/**
+* collects the strings of a frame and draws them in one batch. positions are window
+* coordinates (lower left corner of the first glyph), scale enlarges the glyphs by
+* whole pixels. the atlas texture is created on the first draw(). all windows use the
+* same one, their gl contexts share textures (see Window_manager). the software backend
+* has no textures, it draws the pixels of the glyphs as points instead.
+*/
+class Text_batch
+{
+public:
+	static const int glyph_w = 6, glyph_h = 8; // the font is 5x7 pixels plus spacing
 
-					if (p1.x > trace_max.x)trace_max.x = p1.x;
-					if (p1.y > trace_max.y)trace_max.y = p1.y;					
-					if (p1.x < trace_min.x)trace_min.x = p1.x;
-					if (p1.y < trace_min.y)trace_min.y = p1.y;
-				}
+	Text_batch() {}
+	Text_batch(const Text_batch&) {}
+	Text_batch& operator=(const Text_batch&) { glyphs.clear(); return *this; }
+
+	/**
+	*	width of s in pixels.
+	*/
+	static float width(const std::string& s, int scale = 1) { return float(s.size() * glyph_w * scale); }
+
+	void add(float x, float y, const std::string& s, float r, float g, float b, int scale = 1)
+	{
+		x = std::floor(x + 0.5f);
+		y = std::floor(y + 0.5f);
+		for (unsigned char c : s)
+		{
+			if (c > ' ' && c <= '~') { glyphs.push_back(Glyph{ x, y, r, g, b, scale, c }); }
+			x += float(glyph_w * scale);
+		}
+	}
 
-				// draw a vertical line to indicate current 
-				if (MP_SCROLL_WARP == scroll && pos < size() )
+	size_t size() const { return glyphs.size(); }
+
+	/**
+	*	draws all strings added since the last draw().
+	*/
+	void draw()
+	{
+		if (glyphs.empty()) { return; }
+		#ifdef MULTIPLOT_SOFTWARE
+		for (const Glyph& g : glyphs)
+		{
+			glPointSize(float(g.scale));
+			glColor3f(g.r, g.g, g.b);
+			glBegin(GL_POINTS);
+			const unsigned char* columns = font() + 5 * (g.c - 32);
+			for (int col = 0; col < 5; col++)
+			{
+				for (int row = 0; row < 7; row++)
 				{
-					float x = (*this)[pos].x;
-					glColor3f(0.5f, 0.5f, 0.5f);
-					glVertex2f((x - offset.x)*scale.x, (trace_min.y - offset.y)*scale.y);
-					glVertex2f((x - offset.x)*scale.x, (trace_max.y - offset.y)*scale.y);
+					if (columns[col] & (1 << row)) { glVertex2f(g.x + (col + 0.5f) * g.scale, g.y + (6 - row + 0.5f) * g.scale); }
 				}
+			}
+			glEnd();
+		}
+		#else
+		if (0 == texture) { texture = acquire_atlas(); }
+		quads.clear();
+		for (const Glyph& g : glyphs)
+		{
+			const float u0 = float((g.c - 32) % 16 * 8) / atlas_w, v0 = float((g.c - 32) / 16 * 8) / atlas_h;
+			const float u1 = u0 + 5.0f / atlas_w, v1 = v0 + 7.0f / atlas_h;
+			const float x1 = g.x + 5.0f * g.scale, y1 = g.y + 7.0f * g.scale;
+			quads.push_back(Vertex{ g.x, g.y, u0, v0, g.r, g.g, g.b });
+			quads.push_back(Vertex{ x1,  g.y, u1, v0, g.r, g.g, g.b });
+			quads.push_back(Vertex{ x1,  y1,  u1, v1, g.r, g.g, g.b });
+			quads.push_back(Vertex{ g.x, y1,  u0, v1, g.r, g.g, g.b });
+		}
+		Vertex_buffer::unbind();
+		glEnable(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &quads[0].x);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &quads[0].u);
+		glColorPointer(3, GL_FLOAT, sizeof(Vertex), &quads[0].r);
+		glDrawArrays(GL_QUADS, 0, GLsizei(quads.size()));
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisable(GL_BLEND);
+		glDisable(GL_TEXTURE_2D);
+		#endif
+		glyphs.clear();
+	}
+
+	/**
+	*	stops using the atlas texture, the last user frees it. the gl context must be current.
+	*	use context_alive = false if the context has already been destroyed.
+	*/
+	void release(bool context_alive = true)
+	{
+		#ifndef MULTIPLOT_SOFTWARE
+		if (0 == texture) { return; }
+		Atlas& a = atlas();
+		std::lock_guard<std::mutex> lock(a.mutex);
+		if (0 == --a.users)
+		{
+			if (context_alive) { glDeleteTextures(1, &a.texture); }
+			a.texture = 0;
+		}
+		#endif
+		texture = 0;
+		(void)context_alive;
+	}
 
+	bool has_texture() const { return texture != 0; }
 
-				glEnd();
+protected:
+	struct Glyph { float x, y, r, g, b; int scale; unsigned char c; };
+	struct Vertex { float x, y, u, v, r, g, b; };
+	std::vector<Glyph> glyphs;
+	std::vector<Vertex> quads;
+	GLuint texture = 0;
 
-				if (p1.x > trace_max.x)trace_max.x = p1.x;
-				if (p1.y > trace_max.y)trace_max.y = p1.y;
-				if (p1.x < trace_min.x)trace_min.x = p1.x;
-				if (p1.y < trace_min.y)trace_min.y = p1.y;
+	// 16 x 6 cells of 8x8 texels. (the size is a power of two for opengl 1.1)
+	static const int atlas_w = 128, atlas_h = 64;
 
-				if (trace_max.x > maximum.x)maximum.x = trace_max.x;
-				if (trace_max.y > maximum.y)maximum.y = trace_max.y;
-				if (trace_min.x < minimum.x)minimum.x = trace_min.x;
-				if (trace_min.y < minimum.y)minimum.y = trace_min.y;
+	// the atlas of all windows and the number of Text_batches using it
+	struct Atlas
+	{
+		GLuint texture = 0;
+		size_t users = 0;
+		std::mutex mutex;
+	};
+	static Atlas& atlas() { static Atlas a; return a; }
 
+	#ifndef MULTIPLOT_SOFTWARE
+	GLuint acquire_atlas()
+	{
+		Atlas& a = atlas();
+		std::lock_guard<std::mutex> lock(a.mutex);
+		if (0 == a.texture)
+		{
+			a.texture = create_texture();
+			glFinish(); // the other contexts see the texture only when it is complete
+		}
+		a.users++;
+		return a.texture;
+	}
 
-				// draw the markers / points of the trace
-				float point_size=at(start%size()).line_width;
-				glPointSize(point_size);
-				glBegin(GL_POINTS);
-				for(size_t a=start;a<start+size();a++)
+	static GLuint create_texture()
+	{
+		std::vector<unsigned char> alpha(atlas_w * atlas_h, 0);
+		for (int c = 0; c < 95; c++)
+		{
+			const unsigned char* columns = font() + 5 * c;
+			const int x0 = c % 16 * 8, y0 = c / 16 * 8;
+			for (int col = 0; col < 5; col++)
+			{
+				for (int row = 0; row < 7; row++)	// row 0 is the top of the glyph, texel row 0 the bottom
 				{
-					p=(*this)[a%size()];
-					if(p.point_size>0.0)
-					{
-						// reduce number of opengl state changes.
-						if(p.point_size != point_size)
-						{
-							glEnd();
-							point_size = p.point_size;
-							glPointSize(point_size);
-							glBegin(GL_POINTS);
-						}
-						glColor3f(p.r,p.g,p.b);
-						glVertex2f((p.x-offset.x)*scale.x,(p.y-offset.y)*scale.y);
-					}
-					glEnd();
+					if (columns[col] & (1 << row)) { alpha[(y0 + 6 - row) * atlas_w + x0 + col] = 255; }
 				}
 			}
+		}
+		GLuint texture = 0;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlas_w, atlas_h, 0, GL_ALPHA, GL_UNSIGNED_BYTE, alpha.data());
+		return texture;
+	}
+	#endif
 
-		public:
+	// the characters 32 .. 126, 5 columns each, bit 0 is the top row
+	static const unsigned char* font()
+	{
+		static const unsigned char columns[95 * 5] =
+		{
+			0x00,0x00,0x00,0x00,0x00, 0x00,0x00,0x5F,0x00,0x00, 0x00,0x07,0x00,0x07,0x00, 0x14,0x7F,0x14,0x7F,0x14, // space ! " #
+			0x24,0x2A,0x7F,0x2A,0x12, 0x23,0x13,0x08,0x64,0x62, 0x36,0x49,0x55,0x22,0x50, 0x00,0x05,0x03,0x00,0x00, // $ % & '
+			0x00,0x1C,0x22,0x41,0x00, 0x00,0x41,0x22,0x1C,0x00, 0x08,0x2A,0x1C,0x2A,0x08, 0x08,0x08,0x3E,0x08,0x08, // ( ) * +
+			0x00,0x50,0x30,0x00,0x00, 0x08,0x08,0x08,0x08,0x08, 0x00,0x60,0x60,0x00,0x00, 0x20,0x10,0x08,0x04,0x02, // , - . /
+			0x3E,0x51,0x49,0x45,0x3E, 0x00,0x42,0x7F,0x40,0x00, 0x42,0x61,0x51,0x49,0x46, 0x21,0x41,0x45,0x4B,0x31, // 0 1 2 3
+			0x18,0x14,0x12,0x7F,0x10, 0x27,0x45,0x45,0x45,0x39, 0x3C,0x4A,0x49,0x49,0x30, 0x01,0x71,0x09,0x05,0x03, // 4 5 6 7
+			0x36,0x49,0x49,0x49,0x36, 0x06,0x49,0x49,0x29,0x1E, 0x00,0x36,0x36,0x00,0x00, 0x00,0x56,0x36,0x00,0x00, // 8 9 : ;
+			0x08,0x14,0x22,0x41,0x00, 0x14,0x14,0x14,0x14,0x14, 0x00,0x41,0x22,0x14,0x08, 0x02,0x01,0x51,0x09,0x06, // < = > ?
+			0x32,0x49,0x79,0x41,0x3E, 0x7E,0x11,0x11,0x11,0x7E, 0x7F,0x49,0x49,0x49,0x36, 0x3E,0x41,0x41,0x41,0x22, // @ A B C
+			0x7F,0x41,0x41,0x22,0x1C, 0x7F,0x49,0x49,0x49,0x41, 0x7F,0x09,0x09,0x09,0x01, 0x3E,0x41,0x49,0x49,0x7A, // D E F G
+			0x7F,0x08,0x08,0x08,0x7F, 0x00,0x41,0x7F,0x41,0x00, 0x20,0x40,0x41,0x3F,0x01, 0x7F,0x08,0x14,0x22,0x41, // H I J K
+			0x7F,0x40,0x40,0x40,0x40, 0x7F,0x02,0x0C,0x02,0x7F, 0x7F,0x04,0x08,0x10,0x7F, 0x3E,0x41,0x41,0x41,0x3E, // L M N O
+			0x7F,0x09,0x09,0x09,0x06, 0x3E,0x41,0x51,0x21,0x5E, 0x7F,0x09,0x19,0x29,0x46, 0x46,0x49,0x49,0x49,0x31, // P Q R S
+			0x01,0x01,0x7F,0x01,0x01, 0x3F,0x40,0x40,0x40,0x3F, 0x1F,0x20,0x40,0x20,0x1F, 0x3F,0x40,0x38,0x40,0x3F, // T U V W
+			0x63,0x14,0x08,0x14,0x63, 0x07,0x08,0x70,0x08,0x07, 0x61,0x51,0x49,0x45,0x43, 0x00,0x7F,0x41,0x41,0x00, // X Y Z [
+			0x02,0x04,0x08,0x10,0x20, 0x00,0x41,0x41,0x7F,0x00, 0x04,0x02,0x01,0x02,0x04, 0x40,0x40,0x40,0x40,0x40, // \ ] ^ _
+			0x00,0x01,0x02,0x04,0x00, 0x20,0x54,0x54,0x54,0x78, 0x7F,0x48,0x44,0x44,0x38, 0x38,0x44,0x44,0x44,0x20, // ` a b c
+			0x38,0x44,0x44,0x48,0x7F, 0x38,0x54,0x54,0x54,0x18, 0x08,0x7E,0x09,0x01,0x02, 0x0C,0x52,0x52,0x52,0x3E, // d e f g
+			0x7F,0x08,0x04,0x04,0x78, 0x00,0x44,0x7D,0x40,0x00, 0x20,0x40,0x44,0x3D,0x00, 0x7F,0x10,0x28,0x44,0x00, // h i j k
+			0x00,0x41,0x7F,0x40,0x00, 0x7C,0x04,0x18,0x04,0x78, 0x7C,0x08,0x04,0x04,0x78, 0x38,0x44,0x44,0x44,0x38, // l m n o
+			0x7C,0x14,0x14,0x14,0x08, 0x08,0x14,0x14,0x18,0x7C, 0x7C,0x08,0x04,0x04,0x08, 0x48,0x54,0x54,0x54,0x20, // p q r s
+			0x04,0x3F,0x44,0x40,0x20, 0x3C,0x40,0x40,0x20,0x7C, 0x1C,0x20,0x40,0x20,0x1C, 0x3C,0x40,0x30,0x40,0x3C, // t u v w
+			0x44,0x28,0x10,0x28,0x44, 0x0C,0x50,0x50,0x50,0x3C, 0x44,0x64,0x54,0x4C,0x44, 0x00,0x08,0x36,0x41,0x00, // x y z {
+			0x00,0x00,0x7F,0x00,0x00, 0x00,0x41,0x36,0x08,0x00, 0x08,0x04,0x08,0x10,0x08                           // | } ~
+		};
+		return columns;
+	}
+};
 
-			/**
-			*	plot a point at (x,y) to the currently active trace. 
-			*	you may switch the trace with a call to trace(int _trace)
-			*/
-			void plot(const float x, const float y)
-			{ 
 
-				Point2d p(x,y, cur_col[0], cur_col[1], cur_col[2], cur_line_width, cur_point_size);
+//////////////////////////////////////////////////////////////////////////
+// density maps: the points of a scatter plot counted per pixel and drawn as one texture,
+// so the cost of a frame depends on the size of the window instead of the number of points.
 
-				if(MP_NO_SCROLL != scroll)
-				{
-					// this implements a simple ringbuffer
-					if (pos < size())
-					{
-						(*this)[pos] = p;
-					}
-					else
-					{
-						push_back(p);
-					}
-					pos++;
+/**
+* a histogram with one bin per pixel of the window. add() counts a point at a window
+* position, draw() colors every pixel with points by its count and draws them as one
+* textured quad. the texture belongs to the current gl context and is only freed by
+* release() (see Trace::release_buffers()). the software backend has no textures, it
+* draws the pixels with points as points instead.
+*/
+class Density_map
+{
+public:
+	Density_map() {}
+	Density_map(const Density_map&) {}
+	Density_map(Density_map&& o) noexcept : w(o.w), h(o.h), counts(std::move(o.counts)), max(o.max), texture(o.texture), texture_w(o.texture_w), texture_h(o.texture_h) { o.texture = 0; }
+	Density_map& operator=(const Density_map&) { reset(0, 0); return *this; }
+	// keeps a texture of its own, which only release() frees, and takes the one of o otherwise
+	Density_map& operator=(Density_map&& o) noexcept
+	{
+		if (0 == texture) { texture = o.texture; texture_w = o.texture_w; texture_h = o.texture_h; o.texture = 0; }
+		reset(0, 0);
+		return *this;
+	}
 
-					if(pos >= max_points_to_plot){ pos = 0; }		
-				}
-				else
+	unsigned int width() const { return w; }
+	unsigned int height() const { return h; }
+
+	// removes all counts and sets the size of the map in pixels
+	void reset(unsigned int width, unsigned int height)
+	{
+		w = width;
+		h = height;
+		counts.assign(size_t(w) * h, 0);
+		max = 0;
+		modified = true;
+	}
+
+	// counts a point at the window position (x, y). points on the right or top edge count for the last pixel
+	void add(double x, double y)
+	{
+		if (!(x >= 0.0 && y >= 0.0 && x <= double(w) && y <= double(h)) || 0 == w || 0 == h) { return; }
+		uint32_t& c = counts[std::min(size_t(y), size_t(h - 1)) * w + std::min(size_t(x), size_t(w - 1))];
+		if (++c > max) { max = c; }
+		modified = true;
+	}
+
+	// the number of vertices of the last draw()
+	size_t vertices() const { return drawn; }
+
+	/**
+	*	draws the map in window coordinates. a pixel with points gets a dark shade of the
+	*	color (r, g, b) for few points, the color itself and white for the most points.
+	*	log_scale makes the shade follow the logarithm of the count, so single points stay
+	*	visible next to dense clusters.
+	*/
+	void draw(float r, float g, float b, bool log_scale)
+	{
+		drawn = 0;
+		if (0 == max) { return; }
+		const Colors c{ r, g, b, log_scale };
+		const bool recolor = modified || !(c == colors);
+		colors = c;
+		modified = false;
+		const double top = log_scale ? std::log1p(double(max)) : double(max);
+
+		#ifdef MULTIPLOT_SOFTWARE
+		if (recolor)
+		{
+			points.clear();
+			for (unsigned int y = 0; y < h; y++)
+			{
+				for (unsigned int x = 0; x < w; x++)
 				{
-					push_back(p);
+					const uint32_t n = counts[size_t(y) * w + x];
+					if (0 == n) { continue; }
+					const float t = float((log_scale ? std::log1p(double(n)) : double(n)) / top);
+					points.push_back(Vertex{ x + 0.5f, y + 0.5f, shade(r, t), shade(g, t), shade(b, t) });
 				}
 			}
-
-			/**
-			*	sets the current drawing color in rgb format. 
-			*   r,g,b are in the range [0..1]
-			*/
-			void color3f(float r, float g, float b)
+		}
+		if (points.empty()) { return; }
+		glPointSize(1.0f);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &points[0].x);
+		glColorPointer(3, GL_FLOAT, sizeof(Vertex), &points[0].r);
+		glDrawArrays(GL_POINTS, 0, GLsizei(points.size()));
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		drawn = points.size();
+		#else
+		// the texture size is a power of two for opengl 1.1
+		unsigned int tw = 1, th = 1;
+		while (tw < w) { tw *= 2; }
+		while (th < h) { th *= 2; }
+		if (0 == texture || tw != texture_w || th != texture_h)
+		{
+			if (0 == texture) { glGenTextures(1, &texture); }
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tw, th, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			texture_w = tw;
+			texture_h = th;
+		}
+		glBindTexture(GL_TEXTURE_2D, texture);
+		if (recolor)
+		{
+			rgba.assign(counts.size() * 4, 0);
+			for (size_t i = 0; i < counts.size(); i++)
 			{
-				cur_col[0]=r;
-				cur_col[1]=g;
-				cur_col[2]=b;
+				if (0 == counts[i]) { continue; }
+				const float t = float((log_scale ? std::log1p(double(counts[i])) : double(counts[i])) / top);
+				rgba[4 * i + 0] = (unsigned char)(255.0f * shade(r, t) + 0.5f);
+				rgba[4 * i + 1] = (unsigned char)(255.0f * shade(g, t) + 0.5f);
+				rgba[4 * i + 2] = (unsigned char)(255.0f * shade(b, t) + 0.5f);
+				rgba[4 * i + 3] = 255;
+			}
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+		}
+		const float u = float(w) / tw, v = float(h) / th;
+		Vertex_buffer::unbind();
+		glEnable(GL_TEXTURE_2D);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glColor3f(1.0f, 1.0f, 1.0f);
+		glBegin(GL_QUADS);
+		glTexCoord2f(0, 0); glVertex2f(0, 0);
+		glTexCoord2f(u, 0); glVertex2f(float(w), 0);
+		glTexCoord2f(u, v); glVertex2f(float(w), float(h));
+		glTexCoord2f(0, v); glVertex2f(0, float(h));
+		glEnd();
+		glDisable(GL_BLEND);
+		glDisable(GL_TEXTURE_2D);
+		drawn = 4;
+		#endif
+	}
+
+	/**
+	*	frees the texture. the gl context must be current.
+	*	use context_alive = false if the context has already been destroyed.
+	*/
+	void release(bool context_alive = true)
+	{
+		#ifndef MULTIPLOT_SOFTWARE
+		if (texture && context_alive) { glDeleteTextures(1, &texture); }
+		#endif
+		texture = 0;
+		(void)context_alive;
+	}
+
+	bool has_texture() const { return texture != 0; }
+
+protected:
+	unsigned int w = 0, h = 0;
+	std::vector<uint32_t> counts;	// row 0 is the bottom of the window
+	uint32_t max = 0;
+	bool modified = true;			// counts have changed since the last draw()
+	size_t drawn = 0;
+
+	struct Colors
+	{
+		float r, g, b;
+		bool log_scale;
+		bool operator==(const Colors& o) const { return r == o.r && g == o.g && b == o.b && log_scale == o.log_scale; }
+	} colors{ -1.0f, -1.0f, -1.0f, false };
+
+	struct Vertex { float x, y, r, g, b; };
+	std::vector<Vertex> points;			// software backend
+	std::vector<unsigned char> rgba;
+	GLuint texture = 0;
+	unsigned int texture_w = 0, texture_h = 0;
+
+	// the share t (0 .. 1] of the largest count as a shade of the color component c:
+	// dark for few points, c itself at 0.7 and white at 1
+	static float shade(float c, float t) { return t < 0.7f ? c * (0.3f + t) : c + (1.0f - c) * (t - 0.7f) / 0.3f; }
+};
+
+/**
+* class Frame_cache keeps a copy of a drawn frame in a texture. while the mouse zooms or moves
+* the view, the copy is drawn stretched to the new view instead of the full frame, which is
+* drawn when the mouse rests. the texture belongs to the current gl context. the software
+* backend has no textures, there nothing is captured and valid() stays false.
+*/
+class Frame_cache
+{
+public:
+	Frame_cache() {}
+	Frame_cache(const Frame_cache&) = delete;
+	Frame_cache& operator=(const Frame_cache&) = delete;
+
+	// true if capture() holds a frame of the size width x height
+	bool valid(unsigned int width, unsigned int height) const { return valid_ && width == w && height == h; }
+	void invalidate() { valid_ = false; }
+
+	// copies the frame in the window (of size width x height) into the texture
+	void capture(unsigned int width, unsigned int height)
+	{
+		#ifndef MULTIPLOT_SOFTWARE
+		if (0 == width || 0 == height) { return; }
+		// the texture size is a power of two for opengl 1.1
+		unsigned int tw = 1, th = 1;
+		while (tw < width) { tw *= 2; }
+		while (th < height) { th *= 2; }
+		if (0 == texture || tw != texture_w || th != texture_h)
+		{
+			if (0 == texture) { glGenTextures(1, &texture); }
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, tw, th, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+			texture_w = tw;
+			texture_h = th;
+		}
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		w = width;
+		h = height;
+		valid_ = true;
+		#else
+		(void)width; (void)height;
+		#endif
+	}
+
+	// draws the captured frame into the window rectangle (x0, y0) - (x1, y1)
+	void draw(float x0, float y0, float x1, float y1)
+	{
+		#ifndef MULTIPLOT_SOFTWARE
+		if (!valid_) { return; }
+		const float u = float(w) / texture_w, v = float(h) / texture_h;
+		Vertex_buffer::unbind();
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glEnable(GL_TEXTURE_2D);
+		glColor3f(1.0f, 1.0f, 1.0f);
+		glBegin(GL_QUADS);
+		glTexCoord2f(0, 0); glVertex2f(x0, y0);
+		glTexCoord2f(u, 0); glVertex2f(x1, y0);
+		glTexCoord2f(u, v); glVertex2f(x1, y1);
+		glTexCoord2f(0, v); glVertex2f(x0, y1);
+		glEnd();
+		glDisable(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		#else
+		(void)x0; (void)y0; (void)x1; (void)y1;
+		#endif
+	}
+
+	/**
+	*	frees the texture. the gl context must be current.
+	*	use context_alive = false if the context has already been destroyed.
+	*/
+	void release(bool context_alive = true)
+	{
+		#ifndef MULTIPLOT_SOFTWARE
+		if (texture && context_alive) { glDeleteTextures(1, &texture); }
+		#endif
+		texture = 0;
+		valid_ = false;
+		(void)context_alive;
+	}
+
+	bool has_texture() const { return texture != 0; }
+
+protected:
+	unsigned int w = 0, h = 0;
+	bool valid_ = false;
+	GLuint texture = 0;
+	unsigned int texture_w = 0, texture_h = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// now comes platform specific code for opening a window to draw in
+
+#ifdef MULTIPLOT_FLTK
+
+class Multiplot_base : public Fl_Gl_Window
+{
+protected:
+	unsigned int width = 0;
+	unsigned int height = 0;
+	std::string caption_str;
+public:
+	/**
+	*	this constructor tells multiplot where to put the window on the 
+	*	desktop in pixel-coordinates(x,y) and with wich width and height (w,h)
+	*/
+	Multiplot_base(int x, int y, int w, int h, const std::wstring& title_, bool fullscreen_) : Fl_Gl_Window(x,y,w,h) 
+	  {
+		  width = w;
+		  height = h;
+		  resizable(*this);
+		  caption(title_);
+		  if (fullscreen_) { fullscreen(); }
+	  }
+
+	  bool check()
+	  { 
+		  if (Fl::check()) { return true; } else return false; 
+	  }
+
+	  /** handles the events of all windows and draws the ones that need it, see Window_manager */
+	  static void handle_events() { Fl::check(); }
+
+	  /** false after the window has been closed */
+	  bool is_open() { return 0 != shown(); }
+
+	  virtual void draw() override
+	  {
+		  //Fl_Gl_Window::draw();
+	  }
+
+	  void caption(const std::string& t)
+	  {
+		  caption_str = t;
+		  this->label(caption_str.c_str());
+	  }
+	  void caption(const std::wstring& t)
+	  {
+		  //setup converter
+		  using convert_type = std::codecvt_utf8<wchar_t>;
+		  caption_str = std::wstring_convert<convert_type, wchar_t>().to_bytes(t);
+		  this->label(caption_str.c_str());
+	  }
+
+	  void redraw()
+	  {
+		  check();
+		  Fl_Gl_Window::redraw();
+	  }
+
+}; 
+#endif
+
+#ifdef MULTIPLOT_WIN32
+
+/**
+* class Multiplot_base is for low level Window handling
+* and creates an OpenGL Context.
+*/
+class Multiplot_base
+{
+protected:
+
+	unsigned int width; // window - width
+	unsigned int height; // window - height
+	std::wstring title_str;
+	bool valid_;
+
+	bool active;
+	bool fullscreen;
+	bool open = true;		// false after the window has been closed
+	HDC			hDC;		// Private GDI Device Context
+	HGLRC		hRC;		// Permanent Rendering Context
+	HWND		hWnd;		// Holds Our Window Handle
+	HINSTANCE	hInstance;	// Holds The Instance Of The Application
+
+	// the window class is registered by the first window and unregistered by the last one
+	static int& window_count() { static int n = 0; return n; }
+	// the rendering contexts of all windows share their textures and buffers, see Window_manager
+	static std::vector<HGLRC>& contexts() { static std::vector<HGLRC> c; return c; }
+
+	// mouse input in window pixels (y from the top), handled by Multiplot
+	virtual void mouse_press(int button, int x, int y, bool shift) { (void)button; (void)x; (void)y; (void)shift; }
+	virtual void mouse_drag(int x, int y) { (void)x; (void)y; }
+	virtual void mouse_release(int x, int y) { (void)x; (void)y; }
+	virtual void mouse_wheel(double steps, int x, int y) { (void)steps; (void)x; (void)y; }
+	virtual void mouse_double_click() {}
+	virtual void mouse_rest() {}
+	
+
+	static LRESULT CALLBACK StaticWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
+	{
+		Multiplot_base* pParent;
+
+		// Get pointer to window
+		if(uMsg == WM_CREATE)
+		{
+			pParent = (Multiplot_base*)((LPCREATESTRUCT)lParam)->lpCreateParams;
+			SetWindowLongPtr(hWnd, GWLP_USERDATA,(LONG_PTR)pParent);
+		}
+		else
+		{
+			pParent = (Multiplot_base*)GetWindowLongPtr(hWnd, GWLP_USERDATA);
+			if(!pParent) return DefWindowProc(hWnd,uMsg,wParam,lParam);
+		}
+
+		pParent->hWnd = hWnd;
+		return pParent->WndProc(uMsg,wParam,lParam);
+	}
+
+	LRESULT WndProc(				// Handle For This Window
+		UINT	uMsg,			// Message For This Window
+		WPARAM	wParam,			// Additional Message Information
+		LPARAM	lParam)			// Additional Message Information
+	{
+
+		switch (uMsg)									// Check For Windows Messages
+		{
+		case WM_ACTIVATE:							// Watch For Window Activate Message
+			{
+				if (!HIWORD(wParam))					// Check Minimization State
+				{
+					active=TRUE;						// Program Is Active
+				}
+				else
+				{
+					active=FALSE;						// Program Is No Longer Active
+				}
+
+				return 0;								// Return To The Message Loop
+			}
+
+		case WM_SYSCOMMAND:							// Intercept System Commands
+			{
+				switch (wParam)							// Check System Calls
+				{
+				case SC_SCREENSAVE:					// Screensaver Trying To Start?
+				case SC_MONITORPOWER:				// Monitor Trying To Enter Powersave?
+					return 0;							// Prevent From Happening
+				}
+				break;									// Exit
+			}
+
+		case WM_CLOSE:								// Did We Receive A Close Message?
+			{
+				hide();									// Only This Window Closes, Its check() Returns false
+				return 0;								// Jump Back
+			}
+
+		case WM_KEYDOWN:							// Is A Key Being Held Down?
+			{
+				if (VK_ESCAPE == wParam) { hide(); }	// ESC Closes The Window
+				return 0;								// Jump Back
+			}
+
+		case WM_KEYUP:								// Has A Key Been Released?
+			{
+				//keys[wParam] = FALSE;				// If So, Mark It As FALSE
+				return 0;							// Jump Back
+			}
+
+		case WM_SIZE:								// Resize The OpenGL Window
+			{
+				width = LOWORD(lParam);
+				height = HIWORD(lParam);
+				valid_ = false;						// set flag to tell we need to re-init opengl
+				return 0;							// Jump Back
+			}
+
+		// the mouse zooms and moves the view, see Multiplot::navigation()
+		case WM_LBUTTONDOWN:
+		case WM_RBUTTONDOWN:
+			{
+				SetCapture(hWnd);
+				mouse_press(WM_LBUTTONDOWN == uMsg ? 1 : 3, (short)LOWORD(lParam), (short)HIWORD(lParam), 0 != (wParam & MK_SHIFT));
+				return 0;
+			}
+
+		case WM_MOUSEMOVE:
+			{
+				if (wParam & (MK_LBUTTON | MK_RBUTTON)) { mouse_drag((short)LOWORD(lParam), (short)HIWORD(lParam)); }
+				return 0;
+			}
+
+		case WM_LBUTTONUP:
+		case WM_RBUTTONUP:
+			{
+				ReleaseCapture();
+				mouse_release((short)LOWORD(lParam), (short)HIWORD(lParam));
+				return 0;
+			}
+
+		case WM_LBUTTONDBLCLK:
+			{
+				mouse_double_click();
+				return 0;
+			}
+
+		case WM_MOUSEWHEEL:
+			{
+				POINT p = { (short)LOWORD(lParam), (short)HIWORD(lParam) };	// in screen coordinates
+				ScreenToClient(hWnd, &p);
+				mouse_wheel(-GET_WHEEL_DELTA_WPARAM(wParam) / double(WHEEL_DELTA), p.x, p.y);
+				SetTimer(hWnd, 1, 150, NULL);		// the mouse rests if no wheel event comes for 150 ms
+				return 0;
+			}
+
+		case WM_TIMER:
+			{
+				KillTimer(hWnd, 1);
+				mouse_rest();
+				return 0;
+			}
+		}
+
+		// Pass All Unhandled Messages To DefWindowProc
+		return DefWindowProc(hWnd,uMsg,wParam,lParam);
+	}
+
+
+
+
+
+	/*	This Code Creates Our OpenGL Window.  Parameters Are:					*
+	*	width			- Width Of The GL Window Or Fullscreen Mode				*
+	*	height			- Height Of The GL Window Or Fullscreen Mode			*
+	*	bits			- Number Of Bits To Use For Color (8/16/24/32)			*
+	*/ 
+	bool CreateGLWindow(int x, int y, int width, int height, const std::wstring& title, BYTE bits=0, bool fullscreenflag=false)
+	{
+		GLuint		PixelFormat;			// Holds The Results After Searching For A Match
+		WNDCLASS	wc;						// Windows Class Structure
+		DWORD		dwExStyle;				// Window Extended Style
+		DWORD		dwStyle;				// Window Style
+		RECT		WindowRect;				// Grabs Rectangle Upper Left / Lower Right Values
+		WindowRect.left=(long)0;			// Set Left Value To 0
+		WindowRect.right=(long)width;		// Set Right Value To Requested Width
+		WindowRect.top=(long)0;				// Set Top Value To 0
+		WindowRect.bottom=(long)height;		// Set Bottom Value To Requested Height
+
+		fullscreen=fullscreenflag;			// Set The Global Fullscreen Flag
+		title_str = title;
+
+		hInstance			= GetModuleHandle(NULL);				// Grab An Instance For Our Window
+		wc.style			= CS_HREDRAW | CS_VREDRAW | CS_OWNDC | CS_DBLCLKS;	// Redraw On Size, Own DC For Window, Double Clicks.
+		wc.lpfnWndProc		= (WNDPROC) (Multiplot_base::StaticWndProc);// window_handler Handles Messages
+		wc.cbClsExtra		= 0;									// No Extra Window Data
+		wc.cbWndExtra		= 0;									// No Extra Window Data
+		wc.hInstance		= hInstance;							// Set The Instance
+		wc.hIcon			= LoadIcon(NULL, IDI_WINLOGO);			// Load The Default Icon
+		wc.hCursor			= LoadCursor(NULL, IDC_ARROW);			// Load The Arrow Pointer
+		wc.hbrBackground	= NULL;									// No Background Required For GL
+		wc.lpszMenuName		= NULL;									// We Don't Want A Menu
+		wc.lpszClassName	= L"OpenGL";								// Set The Class Name
+
+
+		if (0 == window_count() && !RegisterClass(&wc))			// Attempt To Register The Window Class (Once For All Windows)
+		{
+			throw std::exception("Failed To Register The Window Class.");
+		}
+		window_count()++;
+
+		if (fullscreen)												// Attempt Fullscreen Mode?
+		{
+			DEVMODE dmScreenSettings;								// Device Mode
+			memset(&dmScreenSettings,0,sizeof(dmScreenSettings));	// Makes Sure Memory's Cleared
+			dmScreenSettings.dmSize=sizeof(dmScreenSettings);		// Size Of The Devmode Structure
+			dmScreenSettings.dmPelsWidth	= width;				// Selected Screen Width
+			dmScreenSettings.dmPelsHeight	= height;				// Selected Screen Height
+			dmScreenSettings.dmBitsPerPel	= bits;					// Selected Bits Per Pixel
+			dmScreenSettings.dmFields=DM_BITSPERPEL|DM_PELSWIDTH|DM_PELSHEIGHT;
+
+			// Try To Set Selected Mode And Get Results.  NOTE: CDS_FULLSCREEN Gets Rid Of Start Bar.
+			if (ChangeDisplaySettings(&dmScreenSettings,CDS_FULLSCREEN)!=DISP_CHANGE_SUCCESSFUL)
+			{
+				// If The Mode Fails, Offer Two Options.  Quit Or Use Windowed Mode.
+				std::cerr << "The Requested Fullscreen Mode is not supported by your Video Card. Using Windowed Mode instead." << std::endl;
+				fullscreen=false;		// Windowed Mode Selected.  Fullscreen = FALSE
+			}
+		}
+
+		if (fullscreen)												// Are We Still In Fullscreen Mode?
+		{
+			dwExStyle=WS_EX_APPWINDOW;								// Window Extended Style
+			dwStyle=WS_POPUP;										// Windows Style
+			ShowCursor(FALSE);										// Hide Mouse Pointer
+		}
+		else
+		{
+			dwExStyle=WS_EX_APPWINDOW | WS_EX_WINDOWEDGE;			// Window Extended Style
+			dwStyle=WS_OVERLAPPEDWINDOW;							// Windows Style
+		}
+
+		AdjustWindowRectEx(&WindowRect, dwStyle, FALSE, dwExStyle);		// Adjust Window To True Requested Size
+
+		// Create The Window
+		if (!(hWnd=CreateWindowEx(	dwExStyle,	// Extended Style For The Window
+			L"OpenGL",							// Class Name
+			title_str.c_str(),							// Window Title
+			dwStyle |							// Defined Window Style
+			WS_CLIPSIBLINGS |					// Required Window Style
+			WS_CLIPCHILDREN,					// Required Window Style
+			x, y,								// Window Position
+			WindowRect.right-WindowRect.left,	// Calculate Window Width
+			WindowRect.bottom-WindowRect.top,	// Calculate Window Height
+			NULL,								// No Parent Window
+			NULL,								// No Menu
+			hInstance,							// Instance
+			this)))								// Dont Pass Anything To WM_CREATE
+		{
+			//KillGLWindow();								// Reset The Display
+			throw std::exception("Window Creation Error.");
+		}
+
+		static	PIXELFORMATDESCRIPTOR pfd=				// pfd Tells Windows How We Want Things To Be
+		{
+			sizeof(PIXELFORMATDESCRIPTOR),				// Size Of This Pixel Format Descriptor
+			1,											// Version Number
+			PFD_DRAW_TO_WINDOW |						// Format Must Support Window
+			PFD_SUPPORT_OPENGL |						// Format Must Support OpenGL
+			PFD_DOUBLEBUFFER,							// Must Support Double Buffering
+			PFD_TYPE_RGBA,								// Request An RGBA Format
+			bits,										// Select Our Color Depth
+			0, 0, 0, 0, 0, 0,							// Color Bits Ignored
+			0,											// No Alpha Buffer
+			0,											// Shift Bit Ignored
+			0,											// No Accumulation Buffer
+			0, 0, 0, 0,									// Accumulation Bits Ignored
+			16,											// 16Bit Z-Buffer (Depth Buffer)  
+			0,											// No Stencil Buffer
+			0,											// No Auxiliary Buffer
+			PFD_MAIN_PLANE,								// Main Drawing Layer
+			0,											// Reserved
+			0, 0, 0										// Layer Masks Ignored
+		};
+
+		if (!(hDC=GetDC(hWnd)))							// Did We Get A Device Context?
+		{
+			//KillGLWindow();								// Reset The Display
+			throw std::exception("Can't Create A GL Device Context.");
+		}
+
+		if (!(PixelFormat=ChoosePixelFormat(hDC,&pfd)))	// Did Windows Find A Matching Pixel Format?
+		{
+			//KillGLWindow();								// Reset The Display
+			throw(std::exception("Can't Find A Suitable PixelFormat."));
+		}
+
+		if(!SetPixelFormat(hDC,PixelFormat,&pfd))		// Are We Able To Set The Pixel Format?
+		{
+			//KillGLWindow();								// Reset The Display
+			throw(std::exception("Can't Set The PixelFormat."));
+		}
+
+		if (!(hRC=wglCreateContext(hDC)))				// Are We Able To Get A Rendering Context?
+		{
+			throw(std::exception("Can't Create A GL Rendering Context."));
+		}
+
+		if (!contexts().empty() && !wglShareLists(contexts().front(), hRC))	// Share Textures And Buffers With The Other Windows
+		{
+			throw(std::exception("Can't Share The GL Rendering Context."));
+		}
+		contexts().push_back(hRC);
+
+		if(!wglMakeCurrent(hDC,hRC))					// Try To Activate The Rendering Context
+		{
+			throw(std::exception("Can't Activate The GL Rendering Context."));
+		}
+
+		ShowWindow(hWnd,SW_SHOW);						// Show The Window
+		SetForegroundWindow(hWnd);						// Slightly Higher Priority
+		SetFocus(hWnd);									// Sets Keyboard Focus To The Window
+		//ReSizeGLScene(width, height);					// Set Up Our Perspective GL Screen
+
+		/*if (!InitGL())									// Initialize Our Newly Created GL Window
+		{
+		KillGLWindow();								// Reset The Display
+		MessageBox(NULL,"Initialization Failed.","ERROR",MB_OK|MB_ICONEXCLAMATION);
+		return FALSE;								// Return FALSE
+		}*/
+
+		return true;									// Success
+	}
+
+	void DestroyGLWindow()
+	{
+		// destroy the window and rendering context
+		if (fullscreen)										// Are We In Fullscreen Mode?
+		{
+			ChangeDisplaySettings(NULL,0);					// If So Switch Back To The Desktop
+			ShowCursor(TRUE);								// Show Mouse Pointer
+		}
+
+		if (hRC)											// Do We Have A Rendering Context?
+		{
+			if (!wglMakeCurrent(NULL,NULL))					// Are We Able To Release The DC And RC Contexts?
+			{
+				throw(std::exception("Release Of DC And RC Failed."));
+			}
+			contexts().erase(std::remove(contexts().begin(), contexts().end(), hRC), contexts().end());
+
+			if (!wglDeleteContext(hRC))						// Are We Able To Delete The RC?
+			{
+				throw(std::exception("Release Rendering Context Failed."));
+			}
+			hRC=NULL;										// Set RC To NULL
+		}
+
+		if (hDC && !ReleaseDC(hWnd,hDC))					// Are We Able To Release The DC
+		{
+			throw(std::exception("Release Device Context Failed."));
+			hDC=NULL;										// Set DC To NULL
+		}
+
+		if (hWnd && !DestroyWindow(hWnd))					// Are We Able To Destroy The Window?
+		{
+			throw(std::exception("Could Not Release hWnd."));
+			hWnd=NULL;										// Set hWnd To NULL
+		}
+
+		if (0 == --window_count() && !UnregisterClass(L"OpenGL",hInstance))	// Are We Able To Unregister Class (After The Last Window)
+		{
+			throw(std::exception("Could Not Unregister Class."));
+			hInstance=NULL;									// Set hInstance To NULL
+		}
+	}
+
+	static LRESULT CALLBACK window_handler(	HWND	hWnd,			// Handle For This Window
+		UINT	uMsg,			// Message For This Window
+		WPARAM	wParam,			// Additional Message Information
+		LPARAM	lParam)			// Additional Message Information
+	{
+		switch (uMsg)									// Check For Windows Messages
+		{
+		case WM_ACTIVATE:							// Watch For Window Activate Message
+			{
+				if (!HIWORD(wParam))					// Check Minimization State
+				{
+					//active=TRUE;						// Program Is Active
+				}
+				else
+				{
+					//active=FALSE;						// Program Is No Longer Active
+				}
+
+				return 0;								// Return To The Message Loop
+			}
+
+		case WM_SYSCOMMAND:							// Intercept System Commands
+			{
+				switch (wParam)							// Check System Calls
+				{
+				case SC_SCREENSAVE:					// Screensaver Trying To Start?
+				case SC_MONITORPOWER:				// Monitor Trying To Enter Powersave?
+					return 0;							// Prevent From Happening
+				}
+				break;									// Exit
+			}
+
+		case WM_CLOSE:								// Did We Receive A Close Message?
+			{
+				PostQuitMessage(0);						// Send A Quit Message
+				return 0;								// Jump Back
+			}
+
+		case WM_KEYDOWN:							// Is A Key Being Held Down?
+			{
+				//keys[wParam] = TRUE;					// If So, Mark It As TRUE
+				return 0;								// Jump Back
+			}
+
+		case WM_KEYUP:								// Has A Key Been Released?
+			{
+				//keys[wParam] = FALSE;					// If So, Mark It As FALSE
+				return 0;								// Jump Back
+			}
+
+		case WM_SIZE:								// Resize The OpenGL Window
+			{
+				LPARAM x = lParam;
+				int xx = LOWORD(lParam);
+				//((Multiplot*)x)->width =x;
+				// todo... problem with member function pointer
+				/*((Multiplot*)wParam)->width = LOWORD(lParam); // LoWord=Width, HiWord=Height
+				((Multiplot*)wParam)->height = HIWORD(lParam);
+				((Multiplot*)wParam)->initgl();*/
+				return 0;								// Jump Back
+			}
+		}
+
+		// Pass All Unhandled Messages To DefWindowProc
+		return DefWindowProc(hWnd,uMsg,wParam,lParam);
+	}
+
+
+	
+public:
+	virtual ~Multiplot_base(){ DestroyGLWindow(); }
+
+	/**
+	*	this constructor tells multiplot where to put the window on the 
+	*	desktop in pixel-coordinates(x,y) and with wich width and height (w,h)
+	*/
+	Multiplot_base(int x, int y, int w, int h, const std::wstring& ttitle, bool fullscreen)
+	{ 
+		hDC=NULL;
+		CreateGLWindow(x, y, w, h, ttitle, 32, fullscreen);
+	}
+
+	/**
+	*	call show() to make the window visible
+	*	only needed if using FLTK as window-creation backend.
+	*/
+	void show()
+	{
+		ShowWindow(hWnd, SW_SHOW);
+		open = true;
+	}
+	
+	void hide()
+	{
+		ShowWindow(hWnd, SW_HIDE);
+		open = false;
+	}
+
+	/**
+	*	propagate window events
+	*	returns false if the window was closed (or ESC was pressed in it), true otherwise
+	*/
+	bool check()
+	{
+		handle_events();
+		return open;
+	}
+
+	/**
+	*	handles the pending messages of all windows of this thread
+	*/
+	static void handle_events()
+	{
+		MSG msg;
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+		{
+			TranslateMessage(&msg); 
+			DispatchMessage(&msg); 
+		}
+	}
+
+	/** false after the window has been closed */
+	bool is_open() { return open; }
+
+	unsigned int w() { return width; }
+	unsigned int h() { return height; }
+	void make_current() { wglMakeCurrent(hDC, hRC); }
+	void release_current() { wglMakeCurrent(NULL, NULL); }
+	void swap_buffers() { SwapBuffers(hDC); }
+	bool valid() { return valid_; }
+	void valid(bool v) { valid_=v; }
+
+	virtual void draw()
+	{
+	}
+
+	void caption(const std::wstring& t)
+	{
+		title_str = t;
+		SetWindowText(hWnd, title_str.c_str());
+	}
+
+	/**
+	* call redraw to refresh the window and to redraw all traces.
+	*/
+	void redraw() 
+	{
+		make_current(); // each window has its own context
+		draw(); 
+		check();
+		SwapBuffers(hDC);
+	}
+};
+
+#endif
+
+#ifdef MULTIPLOT_HEADLESS
+
+/**
+* class Multiplot_base without a window: renders into an offscreen egl pbuffer, so
+* plots can be made on a server without a display. use Multiplot::save() to write
+* the frames to image files. mesa's surfaceless platform is preferred, it needs no
+* x server. link with -lEGL -lGL.
+*/
+class Multiplot_base
+{
+protected:
+	unsigned int width = 0;
+	unsigned int height = 0;
+	std::string caption_str;
+	bool valid_ = false;
+	bool open = true;
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLSurface surface = EGL_NO_SURFACE;
+	EGLContext context = EGL_NO_CONTEXT;
+
+	// the contexts of all windows share their textures and buffers, see Window_manager
+	static std::vector<EGLContext>& contexts() { static std::vector<EGLContext> c; return c; }
+
+public:
+	/**
+	*	creates an offscreen frame buffer with width w and height h. the position
+	*	and fullscreen are ignored.
+	*/
+	Multiplot_base(int /*x*/, int /*y*/, int w, int h, const std::wstring& title_, bool /*fullscreen_*/)
+	{
+		width = w;
+		height = h;
+		caption(title_);
+
+		const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+		PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (get_platform_display && extensions && strstr(extensions, "EGL_MESA_platform_surfaceless"))
+		{
+			display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+		}
+		if (display == EGL_NO_DISPLAY) { display = eglGetDisplay(EGL_DEFAULT_DISPLAY); }
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) { throw std::runtime_error("Multiplot: cannot initialize egl."); }
+
+		const EGLint config_attributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_NONE };
+		EGLConfig config;
+		EGLint configs = 0;
+		if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, config_attributes, &config, 1, &configs) || configs < 1)
+		{
+			if (contexts().empty()) { eglTerminate(display); }
+			throw std::runtime_error("Multiplot: no egl configuration for offscreen opengl rendering.");
+		}
+		const EGLint surface_attributes[] = { EGL_WIDTH, w, EGL_HEIGHT, h, EGL_NONE };
+		surface = eglCreatePbufferSurface(display, config, surface_attributes);
+		context = eglCreateContext(display, config, contexts().empty() ? EGL_NO_CONTEXT : contexts().front(), NULL);
+		if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT)
+		{
+			if (context != EGL_NO_CONTEXT) { eglDestroyContext(display, context); }
+			if (surface != EGL_NO_SURFACE) { eglDestroySurface(display, surface); }
+			if (contexts().empty()) { eglTerminate(display); } // no other window uses the display
+			throw std::runtime_error("Multiplot: cannot create the offscreen frame buffer.");
+		}
+		contexts().push_back(context);
+		make_current();
+	}
+
+	virtual ~Multiplot_base()
+	{
+		release_current();
+		contexts().erase(std::remove(contexts().begin(), contexts().end(), context), contexts().end());
+		eglDestroyContext(display, context);
+		eglDestroySurface(display, surface);
+		if (contexts().empty()) { eglTerminate(display); } // the last window
+	}
+
+	void show() { open = true; }
+	void hide() { open = false; }
+
+	/**
+	*	there are no events without a window. returns false after hide().
+	*/
+	bool check() { return open; }
+	static void handle_events() {}
+	bool is_open() { return open; }
+
+	unsigned int w() { return width; }
+	unsigned int h() { return height; }
+	void make_current() { eglMakeCurrent(display, surface, surface, context); }
+	void release_current() { eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT); }
+	void swap_buffers() { glFinish(); }
+	bool valid() { return valid_; }
+	void valid(bool v) { valid_ = v; }
+
+	virtual void draw()
+	{
+	}
+
+	void caption(const std::string& t) { caption_str = t; }
+	void caption(const std::wstring& t)
+	{
+		using convert_type = std::codecvt_utf8<wchar_t>;
+		caption_str = std::wstring_convert<convert_type, wchar_t>().to_bytes(t);
+	}
+
+	/**
+	* draws a new frame into the offscreen frame buffer.
+	*/
+	void redraw()
+	{
+		make_current();
+		draw();
+		swap_buffers();
+	}
+};
+
+#endif
+
+#ifdef MULTIPLOT_SOFTWARE
+
+/**
+* class Multiplot_base without opengl: draws with the cpu into a frame buffer in main memory
+* (see class Raster). raster() gives access to the pixels, e.g. to copy them into a window of
+* your own gui toolkit, or use Multiplot::save() to write them to an image file.
+* needs no libraries besides the c++ standard library.
+*/
+class Multiplot_base
+{
+protected:
+	unsigned int width = 0;
+	unsigned int height = 0;
+	std::string caption_str;
+	bool valid_ = false;
+	bool open = true;
+	Raster raster_;
+
+public:
+	/**
+	*	creates a frame buffer with width w and height h. the position
+	*	and fullscreen are ignored.
+	*/
+	Multiplot_base(int /*x*/, int /*y*/, int w, int h, const std::wstring& title_, bool /*fullscreen_*/)
+	{
+		width = w;
+		height = h;
+		caption(title_);
+		raster_.resize(w, h);
+		make_current();
+	}
+
+	virtual ~Multiplot_base()
+	{
+		if (Raster::current() == &raster_) { release_current(); }
+	}
+
+	void show() { open = true; }
+	void hide() { open = false; }
+
+	/**
+	*	there are no events without a window. returns false after hide().
+	*/
+	bool check() { return open; }
+	static void handle_events() {}
+	bool is_open() { return open; }
+
+	unsigned int w() { return width; }
+	unsigned int h() { return height; }
+	void make_current() { Raster::current() = &raster_; }
+	void release_current() { Raster::current() = nullptr; }
+	void swap_buffers() { raster_.render(); }
+	bool valid() { return valid_; }
+	void valid(bool v) { valid_ = v; }
+
+	/**
+	*	the frame buffer with the last frame: raster().pixels holds width x height
+	*	pixels as r,g,b,a bytes, the bottom row first.
+	*/
+	const Raster& raster() const { return raster_; }
+
+	virtual void draw()
+	{
+	}
+
+	void caption(const std::string& t) { caption_str = t; }
+	void caption(const std::wstring& t)
+	{
+		using convert_type = std::codecvt_utf8<wchar_t>;
+		caption_str = std::wstring_convert<convert_type, wchar_t>().to_bytes(t);
+	}
+
+	/**
+	* draws a new frame into the frame buffer.
+	*/
+	void redraw()
+	{
+		make_current();
+		draw();
+		swap_buffers();
+	}
+};
+
+#endif
+
+class Window_manager;
+
+/**
+ *	this class creates a window to wich you can add an arbitrary number of 
+ *	autoscaling traces.
+ */
+class Multiplot : public Multiplot_base
+{
+	friend class Window_manager;
+protected:
+	class Color3f
+	{
+	public:
+		float r = 0.0f;
+		float g = 0.0f;
+		float b = 0.0f;
+		Color3f(float r_, float g_, float b_) { r = r_; g = g_; b = b_; }
+	};
+
+	class Point2d
+	{
+	public:
+		float x = 0.0f;
+		float y = 0.0f;
+
+		Point2d() {}
+		Point2d(float xx, float yy) { x = xx; y = yy; }
+	};
+
+	/**
+	*	the color, the width of the line to the next point and the size of the marker of a point.
+	*/
+	struct Style
+	{
+		float r = 1.0f;
+		float g = 1.0f;
+		float b = 1.0f;
+		float line_width = 1.0f;
+		float point_size = 0.0f;
+
+		Style() {}
+		Style(float rr, float gg, float bb, float _lwidth, float _point_size) : r(rr), g(gg), b(bb), line_width(_lwidth), point_size(_point_size) {}
+		bool same_color(const Style& s) const { return r == s.r && g == s.g && b == s.b; }
+		bool operator==(const Style& s) const { return same_color(s) && line_width == s.line_width && point_size == s.point_size; }
+		bool operator!=(const Style& s) const { return !(*this == s); }
+	};
+
+	/**
+	*	a point together with its style, as it is drawn from a vertex array with colors:
+	*	decimated traces, decoded compressed points and the points of a Trace_view.
+	*/
+	class Vertex
+	{
+	public:
+		float x = 0.0f;
+		float y = 0.0f;
+		float r = 1.0f;
+		float g = 1.0f;
+		float b = 1.0f;
+		float point_size = 0.0f;
+		float line_width = 1.0f; // width of the line from this point to the next point
+
+		Vertex() {}
+		Vertex(float xx, float yy, float rr=1, float gg=1, float bb=1, float _lwidth=1.0, float _point_size=0.0)
+		{
+			x=xx;y=yy;
+			r=rr;g=gg;b=bb;
+			point_size=_point_size;
+			line_width=_lwidth;
+		}
+		Vertex(const Point2d& p, const Style& s) : Vertex(p.x, p.y, s.r, s.g, s.b, s.line_width, s.point_size) {}
+		Style style() const { return Style(r, g, b, line_width, point_size); }
+	};
+
+	/**
+	*	the styles of the points of a trace, stored once per run of points with the same style
+	*	instead of once per point. a run starts at the point first and lasts until the next run
+	*	starts. writing points with the style they already have (e.g. appending with an unchanged
+	*	color) leaves the runs as they are.
+	*/
+	class Style_runs
+	{
+	public:
+		struct Run
+		{
+			size_t first;
+			Style style;
+		};
+		std::vector<Run> runs;
+
+		size_t size() const { return runs.size(); }
+		bool empty() const { return runs.empty(); }
+		void clear() { runs = std::vector<Run>(); }
+
+		// the run that contains the point i
+		size_t find(size_t i) const
+		{
+			if (runs.size() == 1) { return 0; }
+			auto later = std::upper_bound(runs.begin(), runs.end(), i, [](size_t v, const Run& r) { return v < r.first; });
+			return size_t(later - runs.begin()) - 1;
+		}
+
+		// the style of the point i
+		const Style& operator[](size_t i) const { return runs[find(i)].style; }
+
+		// the point after the run k of n points
+		size_t end(size_t k, size_t n) const { return k + 1 < runs.size() ? runs[k + 1].first : n; }
+
+		// sets the style of the points [first, last) of n points
+		void assign(size_t first, size_t last, const Style& s, size_t n)
+		{
+			if (first >= last) { return; }
+			if (runs.empty()) { runs.push_back(Run{ 0, s }); return; }
+			const size_t k = find(first);
+			const size_t e = end(k, n);
+			if (runs[k].style == s && e >= last) { return; }
+			if (runs[k].first == first && e == last)
+			{
+				// a whole run is overwritten, e.g. a point with a color of its own in a ringbuffer
+				runs[k].style = s;
+				join(k > 0 ? k - 1 : 0, k + 1);
+				return;
+			}
+			const bool tail = last < n;
+			const Style after = tail ? (*this)[last] : s;
+			const size_t lo = k + (runs[k].first < first ? 1 : 0);
+			auto hi = std::upper_bound(runs.begin() + ptrdiff_t(lo), runs.end(), last, [](size_t v, const Run& r) { return v < r.first; });
+			auto it = runs.insert(runs.erase(runs.begin() + ptrdiff_t(lo), hi), Run{ first, s });
+			if (tail) { runs.insert(it + 1, Run{ last, after }); }
+			join(lo > 0 ? lo - 1 : 0, lo + 2);
+		}
+
+		// removes the first m points
+		void erase_front(size_t m)
+		{
+			if (runs.empty() || m == 0) { return; }
+			runs.erase(runs.begin(), runs.begin() + ptrdiff_t(find(m)));
+			for (Run& r : runs) { r.first = r.first > m ? r.first - m : 0; }
+		}
+
+		// makes the runs cover n points, new points get the style of the last run (or s)
+		void resize(size_t n, const Style& s)
+		{
+			if (n == 0) { clear(); return; }
+			if (runs.empty()) { runs.push_back(Run{ 0, s }); return; }
+			while (runs.back().first >= n) { runs.pop_back(); }
+		}
+
+	protected:
+		// merges the runs [from, to] with the run before them if they have the same style
+		void join(size_t from, size_t to)
+		{
+			for (size_t j = std::min(to, runs.size() - 1); j > from; j--)
+			{
+				if (runs[j].style == runs[j - 1].style) { runs.erase(runs.begin() + ptrdiff_t(j)); }
+			}
+		}
+	};
+
+	/**
+	*	a position in double precision: the bounds of the plot, and the base of the points of a
+	*	trace, which are stored as float offsets to it (see Trace::base()).
+	*/
+	struct Vec2d
+	{
+		double x, y;
+		Vec2d(double x_ = 0.0, double y_ = 0.0) : x(x_), y(y_) {}
+	};
+
+	/**
+	*	maps data to axis coordinates: a logarithmic axis (MP_LOG_GRID) shows log10 of the values.
+	*	the points of the traces stay as they were plotted, only the vertices are transformed.
+	*	values <= 0 have no logarithm, they are put far outside of the window.
+	*/
+	struct Axis_transform
+	{
+		bool log_x, log_y;
+
+		Axis_transform(bool log_x_ = false, bool log_y_ = false) : log_x(log_x_), log_y(log_y_) {}
+		bool linear() const { return !log_x && !log_y; }
+		bool operator==(const Axis_transform& a) const { return log_x == a.log_x && log_y == a.log_y; }
+		bool operator!=(const Axis_transform& a) const { return !(*this == a); }
+
+		static float log(double v) { return v > 0.0 ? float(std::log10(v)) : -38.0f; }
+		float x(float v) const { return log_x ? log(v) : v; }
+		float y(float v) const { return log_y ? log(v) : v; }
+		Point2d operator()(Point2d p) const { p.x = x(p.x); p.y = y(p.y); return p; }
+	};
+
+	/**
+	* a min/max pyramid over the points of a trace. a node of level 0 stores the
+	* indices of the minimum and maximum (of y and of x) of 64 consecutive points, each
+	* level above combines two nodes of the level below. with it, the min/max of any range
+	* of points can be found by looking at a few nodes instead of all points, and the
+	* single node of the top level holds the bounding box of the whole trace.
+	* because the nodes cover storage positions, this also works for ringbuffers:
+	* overwriting the oldest point simply updates the nodes above it.
+	* the pyramid is updated lazily: plot() only marks the changed blocks and
+	* update() recomputes them (and their parents) when they are needed.
+	*/
+	class Lod_pyramid
+	{
+	public:
+		static const size_t block = 64; // number of points summarized by a node of level 0
+
+		struct Node { size_t i_min = 0, i_max = 0, i_xmin = 0, i_xmax = 0; };
+		std::vector< std::vector<Node> > levels;
+
+		size_t block_size(size_t level) const { return block << level; }
+
+		void clear() { levels.clear(); dirty.clear(); dirty_flag.clear(); all_dirty = true; }
+
+		// marks point i as changed
+		void modified(size_t i)
+		{
+			if (all_dirty) { return; }
+			const size_t b = i / block;
+			if (b >= dirty_flag.size()) { dirty_flag.resize(b + 1, 0); }
+			if (!dirty_flag[b]) { dirty_flag[b] = 1; dirty.push_back(b); }
+		}
+
+		// marks the points [first, last) as changed
+		void modified(size_t first, size_t last)
+		{
+			if (all_dirty || first >= last) { return; }
+			for (size_t b = first / block; b <= (last - 1) / block; b++) { modified(b * block); }
+		}
+
+		// marks all points as changed
+		void modified() { all_dirty = true; }
+
+		// recomputes all nodes that contain modified points. p[i] returns the point i
+		template<class P> void update(const P& p, size_t n)
+		{
+			const size_t blocks = (n + block - 1) / block;
+			if (all_dirty)
+			{
+				dirty.resize(blocks);
+				for (size_t b = 0; b < blocks; b++) { dirty[b] = b; }
+				dirty_flag.assign(dirty_flag.size(), 0);
+				levels.clear();
+				all_dirty = false;
+			}
+			if (dirty.empty()) { return; }
+
+			// resize the levels, the new nodes are covered by the dirty list
+			size_t count = blocks;
+			size_t l = 0;
+			do
+			{
+				if (levels.size() <= l) { levels.push_back(std::vector<Node>()); }
+				levels[l].resize(count);
+				count = (count + 1) / 2;
+				l++;
+			} while (levels[l - 1].size() > 1);
+			levels.resize(l);
+
+			std::sort(dirty.begin(), dirty.end());
+			dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+			for (size_t b : dirty)
+			{
+				if (b >= blocks) { continue; }
+				Node& node = levels[0][b];
+				node.i_min = node.i_max = node.i_xmin = node.i_xmax = b * block;
+				const size_t last = std::min(n, (b + 1) * block);
+				for (size_t i = b * block + 1; i < last; i++)
+				{
+					if (smaller(p[i].y, p[node.i_min].y)) { node.i_min = i; }
+					if (larger(p[i].y, p[node.i_max].y)) { node.i_max = i; }
+					if (smaller(p[i].x, p[node.i_xmin].x)) { node.i_xmin = i; }
+					if (larger(p[i].x, p[node.i_xmax].x)) { node.i_xmax = i; }
+				}
+				if (b < dirty_flag.size()) { dirty_flag[b] = 0; }
+			}
+
+			// propagate the changes upwards
+			for (size_t lev = 1; lev < levels.size(); lev++)
+			{
+				size_t k = 0;
+				for (size_t b : dirty)
+				{
+					const size_t parent = b / 2;
+					if (k > 0 && dirty[k - 1] == parent) { continue; }
+					dirty[k++] = parent;
+					if (parent >= levels[lev].size()) { continue; }
+					const std::vector<Node>& below = levels[lev - 1];
+					Node node = below[2 * parent];
+					if (2 * parent + 1 < below.size())
+					{
+						const Node& other = below[2 * parent + 1];
+						if (smaller(p[other.i_min].y, p[node.i_min].y)) { node.i_min = other.i_min; }
+						if (larger(p[other.i_max].y, p[node.i_max].y)) { node.i_max = other.i_max; }
+						if (smaller(p[other.i_xmin].x, p[node.i_xmin].x)) { node.i_xmin = other.i_xmin; }
+						if (larger(p[other.i_xmax].x, p[node.i_xmax].x)) { node.i_xmax = other.i_xmax; }
+					}
+					levels[lev][parent] = node;
+				}
+				dirty.resize(k);
+			}
+			dirty.clear();
+		}
+
+		// a < b and a > b, where nan is replaced by any number: a node is only nan if all its points are
+		static bool smaller(float a, float b) { return a < b || (b != b && a == a); }
+		static bool larger(float a, float b) { return a > b || (b != b && a == a); }
+
+	protected:
+		std::vector<size_t> dirty;		// indices of the modified nodes of level 0
+		std::vector<char> dirty_flag;	// avoids duplicates in the dirty list
+		bool all_dirty = true;
+	};
+
+	/**
+	*	reduces a run of points with non-decreasing x to the first, minimum, maximum and last
+	*	point of every pixel column, using the nodes of a Lod_pyramid over the same points.
+	*	P returns the point i and its style as p[i] (a Vertex* or an accessor).
+	*/
+	class Decimation
+	{
+	public:
+		struct Strip { size_t first, count; };
+		std::vector<Vertex> points;	// the reduced trace that is drawn instead of all points
+		std::vector<Strip> strips;
+
+		void clear() { points.clear(); strips.clear(); }
+
+		// appends the decimated points [first, last) to points.
+		// the pyramid level is chosen such that its nodes are about half a pixel column wide,
+		// so the cost depends on the number of pixel columns, not on the number of points.
+		template<class P> void range(const P& p, const Lod_pyramid& pyramid, size_t first, size_t last, float scale_x, double offset_x)
+		{
+			const double columns = std::max(1.0, double(p[last - 1].x - p[first].x) * scale_x);
+			const double points_per_column = (last - first) / columns;
+			size_t lev = 0;
+			while (lev + 1 < pyramid.levels.size() && 2.0 * pyramid.block_size(lev + 1) <= points_per_column) { lev++; }
+
+			emit_column(); // points added before, see add()
+			for (size_t j = first / pyramid.block_size(lev); j * pyramid.block_size(lev) < last; j++)
+			{
+				node(p, pyramid, lev, j, first, last, scale_x, offset_x);
+			}
+			emit_column();
+		}
+
+		// the pixel column a point falls into
+		static double column(float x, float scale_x, double offset_x) { return floor((double(x) - offset_x) * scale_x); }
+
+		// adds points that are not covered by a pyramid (e.g. a compressed block) to the pixel column c:
+		// the first, minimum, maximum and last of them, the indices give their order.
+		// if c is a new column, the previous column is emitted. flush() emits the last column.
+		void add(double c, const Vertex& first, size_t i_first, const Vertex& min, size_t i_min, const Vertex& max, size_t i_max, const Vertex& last, size_t i_last)
+		{
+			if (!col.empty && c == col.column)
+			{
+				if (min.y < col.p[1].y) { col.p[1] = min; col.i[1] = i_min; }
+				if (max.y > col.p[2].y) { col.p[2] = max; col.i[2] = i_max; }
+				col.p[3] = last; col.i[3] = i_last;
+				return;
+			}
+			emit_column();
+			col.column = c;
+			col.p[0] = first; col.p[1] = min; col.p[2] = max; col.p[3] = last;
+			col.i[0] = i_first; col.i[1] = i_min; col.i[2] = i_max; col.i[3] = i_last;
+			col.empty = false;
+		}
+		void add(double c, const Vertex& p, size_t i) { add(c, p, i, p, i, p, i, p, i); }
+		void flush() { emit_column(); }
+
+	protected:
+		// collects the first, min, max and last point of the current pixel column, and their indices
+		struct Column
+		{
+			double column = 0;
+			Vertex p[4];
+			size_t i[4] = { 0, 0, 0, 0 };
+			bool empty = true;
+		} col;
+
+		// adds the points [first, last] to the pixel column c. i_min and i_max are the
+		// indices of their minimum and maximum.
+		template<class P> void add_to_column(const P& p, double c, size_t first, size_t i_min, size_t i_max, size_t last)
+		{
+			add(c, p[first], first, p[i_min], i_min, p[i_max], i_max, p[last], last);
+		}
+
+		// emit first, min, max, last in their original order
+		void emit_column()
+		{
+			if (col.empty) { return; }
+			const bool max_first = col.i[2] < col.i[1];
+			const int order[4] = { 0, max_first ? 2 : 1, max_first ? 1 : 2, 3 };
+			for (int k = 0; k < 4; k++)
+			{
+				if (k == 0 || col.i[order[k]] != col.i[order[k - 1]]) { points.push_back(col.p[order[k]]); }
+			}
+			col.empty = true;
+		}
+
+		// adds the points of node j of the pyramid level lev, clipped to [first, last), to the columns.
+		// nodes that fall completely into one pixel column are added as a whole, others are split.
+		template<class P> void node(const P& p, const Lod_pyramid& pyramid, size_t lev, size_t j, size_t first, size_t last, float scale_x, double offset_x)
+		{
+			const size_t s = std::max(first, j * pyramid.block_size(lev));
+			const size_t e = std::min(last, (j + 1) * pyramid.block_size(lev));
+			if (s >= e) { return; }
+
+			const double c = column(p[s].x, scale_x, offset_x);
+			const bool whole = (s == j * pyramid.block_size(lev) && e == (j + 1) * pyramid.block_size(lev));
+			if (whole && c == column(p[e - 1].x, scale_x, offset_x))
+			{
+				const Lod_pyramid::Node& n = pyramid.levels[lev][j];
+				add_to_column(p, c, s, n.i_min, n.i_max, e - 1);
+			}
+			else if (lev == 0)
+			{
+				for (size_t i = s; i < e; i++)
+				{
+					add_to_column(p, column(p[i].x, scale_x, offset_x), i, i, i, i);
+				}
+			}
+			else
+			{
+				node(p, pyramid, lev - 1, 2 * j, first, last, scale_x, offset_x);
+				node(p, pyramid, lev - 1, 2 * j + 1, first, last, scale_x, offset_x);
+			}
+		}
+	};
+
+	/**
+	*	the compressed part of a trace, see Trace::compression(). the oldest points are sealed in
+	*	blocks: x is stored as the change of the step between the bits of the float values (a
+	*	regular step costs one bit), y as the xor with the previous value (gorilla style) or, with
+	*	a quantum, as the difference of the rounded multiples of the quantum. the style of the points
+	*	is stored once per run of equal styles. every block, and every segment of 256 points in it,
+	*	keeps its first, minimum, maximum and last point, so a block or segment within a single
+	*	pixel column is drawn without decoding it. a segment also keeps the state of the decoder,
+	*	so it can be decoded on its own.
+	*/
+	class Packed_history
+	{
+	public:
+		size_t block_points = 0;	// points per block, 0: compression is off
+		double quantum = 0.0;		// y is rounded to multiples of it, 0: lossless
+
+		// the bookkeeping of Trace, for the sealed points
+		size_t descents = 0;		// neighbouring points with decreasing x
+		bool markers = false;		// true if any point has a point_size > 0
+		bool uniform = true;		// true if all points have the line_width below
+		float line_width = 1.0f;
+
+		struct Style_run
+		{
+			uint32_t first;		// the index of the first point of the run in its block
+			Style style;
+		};
+
+		static const size_t segment = 256;
+
+		struct Segment
+		{
+			uint32_t bit;				// the position of its first point in the data
+			uint32_t x;					// the decoder state before its first point
+			int64_t step, y;			// y: the bits of the previous value or the previous multiple of the quantum
+			int8_t lead, trail;
+			uint16_t index[4];			// the first point, the minimum and the maximum of y, the last point
+			float key_x[4], key_y[4];
+		};
+
+		struct Block
+		{
+			Vec2d base;				// the points are stored relative to it
+			uint32_t count = 0;
+			double quantum = 0.0;	// 0 if y is stored losslessly
+			Vertex key[4];			// the first point, the minimum and the maximum of y, the last point
+			uint32_t key_index[4] = { 0, 0, 0, 0 };
+			float x_min = 0.0f, x_max = 0.0f;
+			std::vector<Style_run> styles;
+			std::vector<Segment> segments;
+			std::vector<unsigned char> data;
+		};
+		std::vector<Block> blocks;
+
+		bool empty() const { return blocks.empty(); }
+		size_t size() const { return count; }
+
+		// the memory used by the sealed points in bytes
+		size_t bytes() const
+		{
+			size_t b = blocks.capacity() * sizeof(Block);
+			for (const Block& k : blocks) { b += k.data.capacity() + k.styles.capacity() * sizeof(Style_run) + k.segments.capacity() * sizeof(Segment); }
+			return b;
+		}
+
+		// removes all points, the settings are kept
+		void clear()
+		{
+			blocks = std::vector<Block>();
+			count = 0;
+			descents = 0;
+			markers = false;
+			uniform = true;
+		}
+
+		// the bounding box of the sealed points. returns false if there are none
+		bool bounds(double& x_min, double& y_min, double& x_max, double& y_max) const
+		{
+			if (empty()) { return false; }
+			x_min = lo.x; y_min = lo.y; x_max = hi.x; y_max = hi.y;
+			return true;
+		}
+
+		// encodes the points p[0 .. n), which are stored relative to base, as a new block.
+		// the style of p[i] is the style of the point first + i in styles
+		void seal(const Point2d* p, size_t n, const Vec2d& base, const Style_runs& styles, size_t first)
+		{
+			if (n == 0) { return; }
+			blocks.push_back(Block());
+			Block& b = blocks.back();
+			b.base = base;
+			b.count = uint32_t(n);
+			b.quantum = quantum;
+			for (size_t i = 0; i < n && b.quantum > 0.0; i++)
+			{
+				if (!(std::fabs(p[i].y / b.quantum) < 1e15)) { b.quantum = 0.0; } // nan, inf or too large: lossless
+			}
+
+			Bit_writer w{ b.data };
+			uint32_t x = 0;
+			int64_t step = 0, y = 0;
+			int lead = -1, trail = 0;
+			size_t run = styles.find(first);
+			b.segments.reserve((n + segment - 1) / segment);
+			for (size_t i = 0; i < n; i++)
+			{
+				if (i % segment == 0) { b.segments.push_back(Segment{ uint32_t(w.position()), x, step, y, int8_t(lead), int8_t(trail), { 0, 0, 0, 0 }, {}, {} }); }
+				const uint32_t xi = bits(p[i].x);
+				const int64_t s = int64_t(xi) - int64_t(x);
+				put_int(w, s - step);
+				x = xi;
+				step = s;
+
+				float yi = p[i].y;
+				if (b.quantum > 0.0)
+				{
+					const int64_t qi = int64_t(llround(double(yi) / b.quantum));
+					put_int(w, qi - y);
+					y = qi;
+					yi = float(double(qi) * b.quantum);
+				}
+				else
+				{
+					put_xor(w, bits(yi), uint32_t(y), lead, trail);
+					y = bits(yi);
+				}
+
+				Segment& seg = b.segments.back();
+				const uint16_t j = uint16_t(i % segment);
+				if (j == 0 || yi < seg.key_y[1]) { seg.index[1] = j; seg.key_x[1] = p[i].x; seg.key_y[1] = yi; }
+				if (j == 0 || yi > seg.key_y[2]) { seg.index[2] = j; seg.key_x[2] = p[i].x; seg.key_y[2] = yi; }
+				if (j == 0) { seg.key_x[0] = p[i].x; seg.key_y[0] = yi; }
+				seg.index[3] = j; seg.key_x[3] = p[i].x; seg.key_y[3] = yi;
+
+				if (first + i >= styles.end(run, first + n)) { run++; }
+				const Style& style = styles.runs[run].style;
+				const Vertex v(Point2d(p[i].x, yi), style);
+				if (i == 0)
+				{
+					for (int k = 0; k < 4; k++) { b.key[k] = v; }
+					b.x_min = b.x_max = v.x;
+				}
+				if (v.y < b.key[1].y) { b.key[1] = v; b.key_index[1] = uint32_t(i); }
+				if (v.y > b.key[2].y) { b.key[2] = v; b.key_index[2] = uint32_t(i); }
+				b.key[3] = v;
+				b.key_index[3] = uint32_t(i);
+				b.x_min = std::min(b.x_min, v.x);
+				b.x_max = std::max(b.x_max, v.x);
+
+				if (i == 0 || style != b.styles.back().style) { b.styles.push_back(Style_run{ uint32_t(i), style }); }
+				if (i > 0 && !(p[i].x >= p[i - 1].x)) { descents++; } // nan counts as well
+				if (v.point_size > 0.0f) { markers = true; }
+				if (count + i == 0) { line_width = v.line_width; }
+				else if (v.line_width != line_width) { uniform = false; }
+			}
+			w.flush();
+			b.data.shrink_to_fit();
+			b.styles.shrink_to_fit();
+			b.segments.shrink_to_fit();
+
+			const Vec2d block_lo(base.x + b.x_min, base.y + b.key[1].y), block_hi(base.x + b.x_max, base.y + b.key[2].y);
+			if (count == 0) { lo = block_lo; hi = block_hi; }
+			else
+			{
+				if (!(base.x + p[0].x >= blocks[blocks.size() - 2].base.x + blocks[blocks.size() - 2].key[3].x)) { descents++; }
+				lo = Vec2d(std::min(lo.x, block_lo.x), std::min(lo.y, block_lo.y));
+				hi = Vec2d(std::max(hi.x, block_hi.x), std::max(hi.y, block_hi.y));
+			}
+			count += n;
+		}
+
+		// decodes the block k into out. the points are relative to the base of the block
+		void decode(size_t k, std::vector<Vertex>& out) const { decode(k, 0, blocks[k].segments.size(), out); }
+
+		// decodes the segments [s0, s1) of the block k into out
+		void decode(size_t k, size_t s0, size_t s1, std::vector<Vertex>& out) const
+		{
+			const Block& b = blocks[k];
+			const Segment& s = b.segments[s0];
+			const size_t first = s0 * segment, last = std::min(size_t(b.count), s1 * segment);
+			out.resize(last - first);
+			Bit_reader r{ b.data.data() + s.bit / 8 };
+			r.get(int(s.bit % 8));
+			uint32_t x = s.x;
+			int64_t step = s.step, y = s.y;
+			int lead = s.lead, trail = s.trail;
+			size_t run = style_run(b, first);
+			for (size_t i = first; i < last; i++)
+			{
+				step += get_int(r);
+				x = uint32_t(int64_t(x) + step);
+				float yi;
+				if (b.quantum > 0.0)
+				{
+					y += get_int(r);
+					yi = float(double(y) * b.quantum);
+				}
+				else
+				{
+					y = get_xor(r, uint32_t(y), lead, trail);
+					yi = value(uint32_t(y));
+				}
+				if (run + 1 < b.styles.size() && b.styles[run + 1].first == i) { run++; }
+				out[i - first] = Vertex(Point2d(value(x), yi), b.styles[run].style);
+			}
+		}
+
+		/**
+		*	adds the sealed points to the decimation d. vertex(q, base) returns the vertex of the
+		*	point q, which is stored relative to base. a block or segment that falls into one pixel
+		*	column adds its key points, the other segments are decoded. pixel columns left of the window (and right of
+		*	it, if its width in columns is known) are combined into one.
+		*/
+		template<class V> void decimate(Decimation& d, const V& vertex, float scale_x, double offset_x, double columns) const
+		{
+			auto column = [&](float x)
+			{
+				const double c = std::max(-1.0, Decimation::column(x, scale_x, offset_x));
+				return columns > 0.0 ? std::min(c, columns) : c;
+			};
+			std::vector<Vertex> points;
+			size_t index = 0;
+			for (size_t k = 0; k < blocks.size(); k++)
+			{
+				const Block& b = blocks[k];
+				const Vertex first = vertex(b.key[0], b.base), last = vertex(b.key[3], b.base);
+				const double c = column(first.x);
+				if (c == column(last.x))
+				{
+					d.add(c, first, index, vertex(b.key[1], b.base), index + b.key_index[1], vertex(b.key[2], b.base), index + b.key_index[2], last, index + b.key_index[3]);
+				}
+				else
+				{
+					// the same for each segment
+					for (size_t j = 0; j < b.segments.size(); j++)
+					{
+						const Segment& s = b.segments[j];
+						const size_t i0 = index + j * segment;
+						Vertex key[4];
+						for (int m = 0; m < 4; m++) { key[m] = vertex(point(b, j * segment + s.index[m], s.key_x[m], s.key_y[m]), b.base); }
+						const double cs = column(key[0].x);
+						if (cs == column(key[3].x))
+						{
+							d.add(cs, key[0], i0, key[1], i0 + s.index[1], key[2], i0 + s.index[2], key[3], i0 + s.index[3]);
+							continue;
+						}
+						decode(k, j, j + 1, points);
+						for (size_t i = 0; i < points.size(); i++)
+						{
+							const Vertex v = vertex(points[i], b.base);
+							d.add(column(v.x), v, i0 + i);
+						}
+					}
+				}
+				index += b.count;
+			}
+			d.flush();
+		}
+
+	protected:
+		size_t count = 0;	// number of sealed points
+		Vec2d lo, hi;		// bounds
+
+		// writes bits to a byte vector, least significant bit first
+		struct Bit_writer
+		{
+			std::vector<unsigned char>& out;
+			uint64_t bits = 0;
+			int count = 0;
+			void put(uint32_t v, int n)
+			{
+				bits |= uint64_t(v) << count;
+				count += n;
+				while (count >= 8) { out.push_back((unsigned char)bits); bits >>= 8; count -= 8; }
+			}
+			void flush() { if (count > 0) { out.push_back((unsigned char)bits); } bits = 0; count = 0; }
+			size_t position() const { return out.size() * 8 + size_t(count); }
+		};
+
+		struct Bit_reader
+		{
+			const unsigned char* p;
+			uint64_t bits = 0;
+			int count = 0;
+			uint32_t get(int n)
+			{
+				while (count < n) { bits |= uint64_t(*p++) << count; count += 8; }
+				const uint32_t v = uint32_t(bits & ((uint64_t(1) << n) - 1));
+				bits >>= n;
+				count -= n;
+				return v;
+			}
+		};
+
+		static uint32_t bits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+		static float value(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+
+		// the style run of the point i of block b
+		static size_t style_run(const Block& b, size_t i)
+		{
+			auto later = std::upper_bound(b.styles.begin(), b.styles.end(), i, [](size_t v, const Style_run& s) { return v < s.first; });
+			return size_t(later - b.styles.begin()) - 1;
+		}
+
+		// the point i of block b, with its style
+		static Vertex point(const Block& b, size_t i, float x, float y)
+		{
+			return Vertex(Point2d(x, y), b.styles[style_run(b, i)].style);
+		}
+
+		// a signed integer, zigzag encoded (small magnitudes give small numbers). the number of ones
+		// before a zero selects the number of bits that follow: 0, 6, 13, 20, 32 or (five ones) 64
+		static void put_int(Bit_writer& w, int64_t v)
+		{
+			static const int width[6] = { 0, 6, 13, 20, 32, 64 };
+			const uint64_t u = (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+			int k = 0;
+			while (k < 5 && (u >> width[k]) != 0) { k++; }
+			w.put((1u << k) - 1, k < 5 ? k + 1 : 5);
+			if (k == 5) { w.put(uint32_t(u), 32); w.put(uint32_t(u >> 32), 32); }
+			else { w.put(uint32_t(u), width[k]); }
+		}
+
+		static int64_t get_int(Bit_reader& r)
+		{
+			static const int width[6] = { 0, 6, 13, 20, 32, 64 };
+			int k = 0;
+			while (k < 5 && r.get(1)) { k++; }
+			uint64_t u = r.get(k == 5 ? 32 : width[k]);
+			if (k == 5) { u |= uint64_t(r.get(32)) << 32; }
+			return int64_t(u >> 1) ^ -int64_t(u & 1);
+		}
+
+		// the xor of v with the previous value: '0' if it is the same, '10' and the bits that differ if
+		// they fit into the window of the previous xor, otherwise '11', the leading zeros, the number of
+		// bits that differ and these bits
+		static void put_xor(Bit_writer& w, uint32_t v, uint32_t prev, int& lead, int& trail)
+		{
+			const uint32_t x = v ^ prev;
+			if (x == 0) { w.put(0, 1); return; }
+			int l = 0, t = 0;
+			while (!(x & (0x80000000u >> l))) { l++; }
+			while (!(x & (1u << t))) { t++; }
+			if (lead >= 0 && l >= lead && t >= trail)
+			{
+				w.put(1, 2);
+				w.put(x >> trail, 32 - lead - trail);
+				return;
+			}
+			w.put(3, 2);
+			w.put(uint32_t(l), 5);
+			w.put(uint32_t(31 - l - t), 5);
+			w.put(x >> t, 32 - l - t);
+			lead = l;
+			trail = t;
+		}
+
+		static uint32_t get_xor(Bit_reader& r, uint32_t prev, int& lead, int& trail)
+		{
+			if (!r.get(1)) { return prev; }
+			if (r.get(1))
+			{
+				lead = int(r.get(5));
+				trail = 32 - lead - int(r.get(5)) - 1;
+			}
+			return prev ^ (r.get(32 - lead - trail) << trail);
+		}
+	};
+
+	/**
+	*	the grid lines and labels of one axis. update() computes them only when the visible range,
+	*	the grid style or the step have changed, otherwise a frame just reads them. positions are
+	*	axis coordinates, i.e. log10 of the value on a logarithmic axis. the number of lines is
+	*	limited by the caller (usually by the number of pixels), a step that would give more lines
+	*	is enlarged, so any range can be shown.
+	*/
+	class Axis_ticks
+	{
+	public:
+		struct Tick
+		{
+			double pos;
+			bool major;
+			std::string label;	// empty for unlabeled minor ticks
+		};
+		std::vector<Tick> ticks;
+		double step = 0;		// distance of the major ticks in axis coordinates
+
+		// returns true if the ticks have been recomputed
+		bool update(int style, double lo, double hi, double user_step, size_t max_ticks)
+		{
+			if (style == key.style && lo == key.lo && hi == key.hi && user_step == key.user_step && max_ticks == key.max_ticks) { return false; }
+			key = Key{ style, lo, hi, user_step, max_ticks };
+			ticks.clear();
+			step = 0;
+			if (!(hi > lo) || !std::isfinite(hi - lo) || max_ticks == 0) { return true; }
+			if (MP_LOG_GRID == style) { log_ticks(lo, hi, max_ticks); }
+			else if (MP_LINEAR_GRID == style) { linear_ticks(lo, hi, user_step, max_ticks); }
+			return true;
+		}
+
+	protected:
+		struct Key
+		{
+			int style = -1;
+			double lo = 0, hi = 0, user_step = 0;
+			size_t max_ticks = 0;
+		} key;
+
+		void add(double pos, bool major, bool labeled, double value, int digits = 6)
+		{
+			char buf[32];
+			buf[0] = 0;
+			if (labeled) { snprintf(buf, sizeof(buf), "%.*g", digits, value); }
+			ticks.push_back(Tick{ pos, major, buf });
+		}
+
+		// multiples of step. the automatic step is a power of ten (halved if there would be less than 4 lines)
+		void linear_ticks(double lo, double hi, double user_step, size_t max_ticks)
+		{
+			const double diff = hi - lo;
+			if (user_step > 0) { step = user_step; }
+			else
+			{
+				step = pow(10.0, floor(log10(diff)));
+				if (diff / step < 4) { step *= 0.5; }
+			}
+			// too many lines: 1, 2, 5, 10, 20, 50 .. times the step
+			const double factors[3] = { 2.0, 2.5, 2.0 };
+			for (int k = 0; diff / step > double(max_ticks); k++) { step *= factors[k % 3]; }
+
+			// enough digits to tell neighbouring labels apart, e.g. for timestamps far from 0
+			const double magnitude = std::max(fabs(lo), fabs(hi));
+			const int digits = std::min(17, std::max(6, int(floor(log10(magnitude)) - floor(log10(step))) + 2));
+
+			const double first = ceil(lo / step);
+			const double count = floor(hi / step) - first + 1;
+			for (double i = 0; i < count; i++)
+			{
+				const double v = (first + i) * step;
+				add(v, true, true, fabs(v) < 1e-6 * step ? 0.0 : v, digits); // no -0 or 1e-17 instead of 0
+			}
+		}
+
+		// a major tick at every decade (or every 2nd, 5th, 10th .. decade), minor ticks at 2 .. 9 times
+		// the decade if there is room for them. less than a decade has labels at the minor ticks, too
+		void log_ticks(double lo, double hi, size_t max_ticks)
+		{
+			step = 1;
+			const double factors[3] = { 2.0, 2.5, 2.0 };
+			for (int k = 0; (hi - lo) / step > double(max_ticks); k++) { step *= factors[k % 3]; }
+			const bool minor = step == 1 && 9 * (hi - lo) <= double(max_ticks);
+			const bool label_minor = hi - lo < 1;
+
+			for (double d = floor(lo / step) * step; d <= hi; d += step)
+			{
+				if (d >= lo) { add(d, true, true, pow(10.0, d)); }
+				for (int k = 2; minor && k <= 9; k++)
+				{
+					const double pos = d + log10(double(k));
+					if (pos < lo) { continue; }
+					if (pos > hi) { break; }
+					add(pos, false, label_minor, k * pow(10.0, d));
+				}
+			}
+		}
+	};
+
+public:
+		// class Trace describes a single trace
+		// if scroll=true it works as a ringbuffer.
+		// the ringbuffer is filled till max_points.
+		// pos stores the actual read/write position in the ringbuffer
+
+		/**
+		* class Trace describes a single Trace. A Multiplot-Window can
+		* contain an unlimited number of Traces.
+		*/
+		class Trace : public std::vector<Point2d>
+		{
+		public:
+			unsigned int max_points_to_plot = std::numeric_limits<unsigned int>::max();
+			MP_SCROLLING scroll = MP_NO_SCROLL;
+			size_t pos = 0; // current position in the ringbuffer
+			float cur_col[3]{ 1.0f, 1.0f, 1.0f };
+			float cur_line_width = 1.0f;
+			float cur_point_size = 0.0f;
+
+			Vertex_buffer vbo; // copy of the points on the graphics card
+			bool changed = true; // true if the trace looks different since it was drawn last
+
+			// set by Multiplot::record(): where the calls of this trace are logged, and its number
+			Session_recorder* recorder = nullptr;
+			unsigned int index = 0;
+
+			size_t plotted = 0; // number of points plotted so far, including the ones that scrolled out again
+
+			bool has_buffers() const { return vbo.id || color_vbo.id || lod_vbo.id || transformed_vbo.id || history_vbo.id || density_map.has_texture(); }
+
+			/**
+			*	frees the buffers on the graphics card. the gl context must be current.
+			*	use context_alive = false if the context has already been destroyed.
+			*/
+			void release_buffers(bool context_alive = true) { vbo.release(context_alive); color_vbo.release(context_alive); lod_vbo.release(context_alive); transformed_vbo.release(context_alive); history_vbo.release(context_alive); density_map.release(context_alive); }
+
+			/**
+			*	returns the bounding box of all points of this trace without drawing it.
+			*	the bounds are maintained as points are plotted (for scrolling traces,
+			*	points that drop out of the ringbuffer are removed from the bounds), so
+			*	this only costs a lookup. returns false if the trace is empty.
+			*/
+			bool bounds(double& x_min, double& y_min, double& x_max, double& y_max)
+			{
+				if (empty()) { return history.bounds(x_min, y_min, x_max, y_max); }
+				pyramid.update(data(), size());
+				const Lod_pyramid::Node& root = pyramid.levels.back()[0];
+				x_min = origin.x + (*this)[root.i_xmin].x;
+				x_max = origin.x + (*this)[root.i_xmax].x;
+				y_min = origin.y + (*this)[root.i_min].y;
+				y_max = origin.y + (*this)[root.i_max].y;
+				double a, b, c, d;
+				if (history.bounds(a, b, c, d))
+				{
+					x_min = std::min(x_min, a); y_min = std::min(y_min, b);
+					x_max = std::max(x_max, c); y_max = std::max(y_max, d);
+				}
+				return true;
+			}
+
+			/**
+			*	extends minimum / maximum such that all points of this trace are enclosed.
+			*/
+			void extend_bounds(Vec2d& minimum, Vec2d& maximum)
+			{
+				double x_min, y_min, x_max, y_max;
+				if (!bounds(x_min, y_min, x_max, y_max)) { return; }
+				if (x_max > maximum.x)maximum.x = x_max;
+				if (y_max > maximum.y)maximum.y = y_max;
+				if (x_min < minimum.x)minimum.x = x_min;
+				if (y_min < minimum.y)minimum.y = y_min;
+			}
+
+			/**
+			*	the points of the trace are stored as float offsets to base(), so large values like
+			*	unix timestamps keep the precision of their differences. the first point chooses the
+			*	base (0 for values below 65536), and it moves along when the points drift so far away
+			*	from it that their offsets would lose precision. the point p is at base() + (p.x, p.y).
+			*/
+			Vec2d base() const { return origin; }
+
+			/**
+			*	draws the trace. the points are stored relative to base(), the caller sets up the
+			*	modelview matrix to scale axis coordinates to the window, the trace moves them by
+			*	base() - offset. scale and offset also give the pixel columns for the decimation.
+			*	with a logarithmic axis, a transformed copy of the points is drawn instead.
+			*	width and height are the size of the window in pixels (0 if unknown), points outside
+			*	of it are not drawn (see cull()) and compressed ones are not decoded. a density map has
+			*	the size of the window.
+			*/
+			void draw(const Point2d& scale, const Vec2d& offset, const Axis_transform& axes = Axis_transform(), double width = 0.0, double height = 0.0)
+			{
+				if (size() == 0 && history.empty()) { return; }
+
+				const size_t n = size();
+				transform(axes);
+
+				// the offset in the coordinates of the vertices
+				const Vec2d local(axes.log_x ? offset.x : offset.x - origin.x, axes.log_y ? offset.y : offset.y - origin.y);
+				if (density_on)
+				{
+					draw_density(scale, local, width, height);
+					return;
+				}
+				glPushMatrix();
+				glTranslatef(float(-local.x), float(-local.y), 0.0f);
+				count_state();
+				set_window(scale, local, width, height);
+
+				if (decimate(scale, local, width))
+				{
+					const char* base = lod_vbo.bind(decimated.points.data(), decimated.points.size() * sizeof(Vertex));
+					glEnableClientState(GL_VERTEX_ARRAY);
+					glEnableClientState(GL_COLOR_ARRAY);
+					glVertexPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, x));
+					glColorPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, r));
+					glLineWidth(decimated.points[0].line_width); // the line width is uniform, see decimate()
+					count_state(3);
+					for (const Decimation::Strip& s : decimated.strips)
+					{
+						glDrawArrays(GL_LINE_STRIP, GLint(s.first), GLsizei(s.count));
+						count_draw(s.count);
+					}
+				}
+				else
+				{
+					if (!history.empty()) { draw_history(scale, local, width); }
+					update_colors();
+					const char* base = axes.linear() ? vbo.bind(data(), n * sizeof(Point2d)) : transformed_vbo.bind(transformed.data(), n * sizeof(Point2d));
+					glEnableClientState(GL_VERTEX_ARRAY);
+					glVertexPointer(2, GL_FLOAT, sizeof(Point2d), base + offsetof(Point2d, x));
+					if (colors.empty()) { glDisableClientState(GL_COLOR_ARRAY); }
+					else
+					{
+						const char* rgb = color_vbo.bind(colors.data(), colors.size() * sizeof(float));
+						glEnableClientState(GL_COLOR_ARRAY);
+						glColorPointer(3, GL_FLOAT, 0, rgb);
+					}
+					count_state(2);
+
+					// the ringbuffer is drawn as (up to) two contiguous ranges
+					if (MP_SCROLL_LEFT == scroll && pos > 0 && pos < n)
+					{
+						draw_visible_lines(pos, n);
+						if (styles[n - 1].line_width > 0) // connect the newest with the oldest part
+						{
+							glLineWidth(styles[n - 1].line_width);
+							count_state();
+							draw_seam(n - 1, 0);
+						}
+						draw_visible_lines(0, pos);
+					}
+					else if (MP_SCROLL_WARP == scroll && pos < n)
+					{
+						draw_visible_lines(0, pos);
+						draw_visible_lines(pos, n);
+					}
+					else
+					{
+						draw_visible_lines(0, n);
+					}
+
+					draw_visible_points(0, n);
+				}
+
+				glDisableClientState(GL_COLOR_ARRAY);
+				glDisableClientState(GL_VERTEX_ARRAY);
+				Vertex_buffer::unbind();
+
+				// draw a vertical line to indicate current
+				if (MP_SCROLL_WARP == scroll && pos < n)
+				{
+					double x_min = 0, y_min = 0, x_max = 0, y_max = 0;
+					bounds(x_min, y_min, x_max, y_max);
+					const float x = to_axis((*this)[pos]).x;
+					glColor3f(0.5f, 0.5f, 0.5f);
+					glBegin(GL_LINES);
+					glVertex2f(x, axes.log_y ? Axis_transform::log(y_min) : float(y_min - origin.y));
+					glVertex2f(x, axes.log_y ? Axis_transform::log(y_max) : float(y_max - origin.y));
+					glEnd();
+					count_state();
+					count_draw(2);
+				}
+				glPopMatrix();
+			}
+
+		protected:
+			// the styles of the points, see Style_runs. a trace with many runs (e.g. a color per point)
+			// is drawn with a color array instead of a state change per run, its colors are kept up to
+			// date while there are many runs.
+			static const size_t many_runs = 256;
+			Style_runs styles;
+			std::vector<float> colors;			// r, g, b of every point, empty if there are few runs
+			Vertex_buffer color_vbo;
+
+			// bookkeeping for the decimation. maintained by plot()
+			size_t descents = 0;				// number of neighbouring points (in storage order) with decreasing x
+			bool descents_valid = true;			// false after modified(), recounted on the next draw
+			bool has_markers = false;			// true if any point has a point_size > 0
+			bool uniform_line_width = true;		// true if all points have the same line_width
+
+			Decimation decimated;				// the reduced trace that is drawn instead of all points
+			Lod_pyramid pyramid;				// min/max of blocks of points, for the bounds and to decimate without looking at every point
+			Vertex_buffer lod_vbo;				// copy of the reduced trace on the graphics card
+			bool decimated_valid = false;
+			Point2d decimated_scale;
+			Vec2d decimated_offset;
+			double decimated_width = 0.0;
+
+			// see density(). the points [0, binned) are counted in the map (for the scale and offset below),
+			// the compressed ones as well. appended points are counted as they are drawn
+			bool density_on = false;
+			bool density_log = true;
+			Density_map density_map;
+			bool density_valid = false;
+			size_t binned = 0;
+			Point2d density_scale;
+			Vec2d density_offset;
+
+			// the older points in compressed blocks, see compression()
+			Packed_history history;
+			Vertex_buffer history_vbo;			// decoded blocks, if the trace can't be decimated
+
+			// see base(). a value further than rebase_limit from the origin is checked by rebase()
+			Vec2d origin;
+			Vec2d rebase_limit{ -1.0, -1.0 };
+
+			// makes sure that the point (x, y) can be stored relative to the origin
+			void check_base(double x, double y) { check_base(x, y, x, y); }
+
+			// makes sure that all points in [x_lo, x_hi] x [y_lo, y_hi] can be stored relative to the origin
+			void check_base(double x_lo, double y_lo, double x_hi, double y_hi)
+			{
+				if (std::fabs(x_lo - origin.x) <= rebase_limit.x && std::fabs(x_hi - origin.x) <= rebase_limit.x &&
+					std::fabs(y_lo - origin.y) <= rebase_limit.y && std::fabs(y_hi - origin.y) <= rebase_limit.y) { return; }
+				if (!std::isfinite(x_lo) || !std::isfinite(y_lo) || !std::isfinite(x_hi) || !std::isfinite(y_hi)) { return; }
+				double x_min = x_lo, y_min = y_lo, x_max = x_hi, y_max = y_hi;
+				if (empty() && history.empty()) { origin = Vec2d(0.0, 0.0); }
+				else { bounds(x_min, y_min, x_max, y_max); }
+				const Vec2d old = origin;
+				const bool moved_x = rebase(origin.x, rebase_limit.x, x_min, x_max, x_lo, x_hi);
+				const bool moved_y = rebase(origin.y, rebase_limit.y, y_min, y_max, y_lo, y_hi);
+				if (!moved_x && !moved_y) { return; }
+				for (Point2d& p : *this)
+				{
+					p.x = float(double(p.x) + old.x - origin.x);
+					p.y = float(double(p.y) + old.y - origin.y);
+				}
+				modified();
+			}
+
+			// moves the origin of one axis to the middle of the new values [v_lo, v_hi] if the points
+			// [lo, hi] (including the new ones) are so far from it that a float offset would resolve less
+			// than 1/4096 of their spread. values below 65536 are always stored directly.
+			// returns true if the origin has moved
+			static bool rebase(double& origin, double& limit, double lo, double hi, double v_lo, double v_hi)
+			{
+				lo = std::min(lo, v_lo);
+				hi = std::max(hi, v_hi);
+				const double spread = hi - lo;
+				const double distance = std::max(std::fabs(lo - origin), std::fabs(hi - origin));
+				const bool moved = distance > 2048.0 * spread && std::max(std::fabs(lo), std::fabs(hi)) >= 65536.0;
+				if (moved) { origin = 0.5 * (v_lo + v_hi); }
+				limit = std::max(2048.0 * spread, origin == 0.0 ? 65536.0 : 0.0);
+				return moved;
+			}
+
+			// the points in axis coordinates, kept up to date while an axis is logarithmic. the transform
+			// is monotonic, so the pyramid and the descents of the points are valid for the copy as well.
+			Axis_transform axes;
+			std::vector<Point2d> transformed;
+			Vertex_buffer transformed_vbo;
+			bool transformed_valid = false;
+
+			// the points that are drawn: the plotted ones, or their transformed copy
+			const Point2d* vertices() const { return axes.linear() ? data() : transformed.data(); }
+
+			// switches to the axis transform a and transforms all points if it has changed
+			void transform(const Axis_transform& a)
+			{
+				if (a != axes) { axes = a; transformed_valid = false; decimated_valid = false; density_valid = false; }
+				if (axes.linear())
+				{
+					if (!transformed.empty()) { transformed = std::vector<Point2d>(); }
+					return;
+				}
+				if (transformed_valid && transformed.size() == size()) { return; }
+				transformed.resize(size());
+				for (size_t i = 0; i < size(); i++) { transformed[i] = to_axis((*this)[i]); }
+				transformed_valid = true;
+				transformed_vbo.modified = true;
+			}
+
+			// the vertex of the point p: p itself, or on a logarithmic axis log10 of base() + p
+			Point2d to_axis(Point2d p) const
+			{
+				if (axes.log_x) { p.x = Axis_transform::log(origin.x + p.x); }
+				if (axes.log_y) { p.y = Axis_transform::log(origin.y + p.y); }
+				return p;
+			}
+
+			// the vertex of a compressed point p, which is stored relative to base (see Packed_history)
+			template<class P> P to_axis(P p, const Vec2d& base) const
+			{
+				p.x = axes.log_x ? Axis_transform::log(base.x + p.x) : float(base.x - origin.x + p.x);
+				p.y = axes.log_y ? Axis_transform::log(base.y + p.y) : float(base.y - origin.y + p.y);
+				return p;
+			}
+
+			// compresses the oldest points while more than two blocks of them are uncompressed
+			void seal()
+			{
+				const size_t b = history.block_points;
+				if (b == 0 || MP_NO_SCROLL != scroll || size() < 2 * b) { return; }
+				const size_t n = (size() / b - 1) * b;
+				for (size_t i = 0; i < n; i += b) { history.seal(data() + i, b, origin, styles, i); }
+				erase(begin(), begin() + ptrdiff_t(n));
+				styles.erase_front(n);
+				const bool counted = density_valid && binned >= n;
+				modified(); // the remaining points have moved to the front
+				if (counted) { density_valid = true; binned -= n; } // the sealed points stay counted in the density map
+			}
+
+			// true if x decreases from point i to i + 1, or one of them is nan (x is not sorted)
+			bool descent(size_t i) const { return !((*this)[i + 1].x >= (*this)[i].x); }
+
+			// counts the descents again after modified()
+			void update_descents()
+			{
+				if (descents_valid) { return; }
+				descents = 0;
+				for (size_t i = 0; i + 1 < size(); i++) { descents += descent(i); }
+				descents_valid = true;
+			}
+
+			// true if x is sorted within the ranges that are drawn as one strip each (see draw())
+			bool sorted()
+			{
+				update_descents();
+				return descents == 0 || (MP_NO_SCROLL != scroll && pos > 0 && pos < size() && descents - descent(pos - 1) == 0);
+			}
+
+			/**
+			*	culling: only the points in the window, widened by the largest marker or line width, and
+			*	their neighbours are drawn. if x is sorted, they are found by binary search, otherwise by
+			*	the nodes of the pyramid: a node is skipped if its bounding box, together with the first
+			*	point of the next node (the end of its last line), is outside of the window.
+			*/
+			struct Window
+			{
+				bool on = false;			// false if the size of the window is unknown
+				double x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+			} window;
+			struct Range { size_t first, last; };
+			std::vector<Range> visible;		// see cull()
+
+			// sets the window in vertex coordinates. offset is the vertex at its lower left corner
+			void set_window(const Point2d& scale, const Vec2d& offset, double width, double height)
+			{
+				float margin = 1.0f;
+				for (const Style_runs::Run& r : styles.runs) { margin = std::max(margin, 0.5f * std::max(r.style.point_size, r.style.line_width) + 1.0f); }
+				const double w = width / scale.x, h = height / scale.y, mx = margin / std::fabs(scale.x), my = margin / std::fabs(scale.y);
+				window.on = width > 0.0 && height > 0.0 && std::isfinite(w) && std::isfinite(h) && w != 0.0 && h != 0.0;
+				window.x0 = std::min(offset.x, offset.x + w) - mx;
+				window.x1 = std::max(offset.x, offset.x + w) + mx;
+				window.y0 = std::min(offset.y, offset.y + h) - my;
+				window.y1 = std::max(offset.y, offset.y + h) + my;
+			}
+
+			// narrows the sorted points [first, last) to the ones in the window and one neighbour on each side
+			void clip_sorted(size_t& first, size_t& last) const
+			{
+				if (first >= last) { return; }
+				const Point2d* p = vertices();
+				const Point2d* a = std::lower_bound(p + first, p + last, window.x0, [](const Point2d& q, double x) { return q.x < x; });
+				const Point2d* b = std::upper_bound(a, p + last, window.x1, [](double x, const Point2d& q) { return x < q.x; });
+				first = std::max(first, size_t(a - p) - (a > p + first ? 1 : 0));
+				last = std::min(last, size_t(b - p) + 1);
+			}
+
+			// the ranges of the points [first, last) that have to be drawn, in visible
+			void cull(size_t first, size_t last)
+			{
+				visible.clear();
+				if (first >= last) { return; }
+				if (!window.on) { visible.push_back(Range{ first, last }); return; }
+				if (sorted())
+				{
+					// a ringbuffer is sorted on both sides of pos
+					const bool split = MP_NO_SCROLL != scroll && first < pos && pos < last;
+					Range parts[2] = { { first, split ? pos : last }, { pos, last } };
+					for (int k = 0; k < (split ? 2 : 1); k++)
+					{
+						clip_sorted(parts[k].first, parts[k].last);
+						if (parts[k].last > parts[k].first) { visible.push_back(parts[k]); }
+					}
+					return;
+				}
+				pyramid.update(data(), size());
+				cull_node(pyramid.levels.size() - 1, 0, first, last);
+			}
+
+			// adds the points of node j of the pyramid level lev that have to be drawn to visible
+			void cull_node(size_t lev, size_t j, size_t first, size_t last)
+			{
+				const size_t s = std::max(first, j * pyramid.block_size(lev)), e = std::min(size(), (j + 1) * pyramid.block_size(lev));
+				if (s >= std::min(e, last)) { return; }
+				const Point2d* p = vertices();
+				const Lod_pyramid::Node& node = pyramid.levels[lev][j];
+				float x0 = p[node.i_xmin].x, x1 = p[node.i_xmax].x, y0 = p[node.i_min].y, y1 = p[node.i_max].y;
+				if (e < size())
+				{
+					x0 = std::min(x0, p[e].x); x1 = std::max(x1, p[e].x);
+					y0 = std::min(y0, p[e].y); y1 = std::max(y1, p[e].y);
+				}
+				if (x1 < window.x0 || x0 > window.x1 || y1 < window.y0 || y0 > window.y1) { return; }
+				const bool inside = x0 >= window.x0 && x1 <= window.x1 && y0 >= window.y0 && y1 <= window.y1;
+				if (lev > 0 && !inside)
+				{
+					cull_node(lev - 1, 2 * j, first, last);
+					cull_node(lev - 1, 2 * j + 1, first, last);
+					return;
+				}
+				const Range r{ s, std::min(e + 1, last) };
+				if (!visible.empty() && visible.back().last >= r.first) { visible.back().last = r.last; }
+				else { visible.push_back(r); }
+			}
+
+			// draws the lines between the points [first, last) that can be seen
+			void draw_visible_lines(size_t first, size_t last)
+			{
+				cull(first, last);
+				for (const Range& r : visible) { draw_lines(r.first, r.last); }
+			}
+
+			// draws the markers of the points [first, last) that can be seen
+			void draw_visible_points(size_t first, size_t last)
+			{
+				if (!has_markers) { return; }
+				cull(first, last);
+				for (const Range& r : visible) { draw_points(r.first, r.last); }
+			}
+
+			// removes the descents next to the points [first, last) from the count before they are
+			// overwritten (add = false) or adds them again after they have been written (add = true)
+			void count_descents(size_t first, size_t last, bool add)
+			{
+				size_t d = 0;
+				const size_t end = std::min(last, size() - std::min(size(), size_t(1)));
+				for (size_t i = first > 0 ? first - 1 : 0; i < end; i++) { d += descent(i); }
+				if (add) { descents += d; } else { descents -= d; }
+			}
+
+			// updates the bookkeeping after the points [first, last) have been written with style s
+			void written(size_t first, size_t last, const Style& s)
+			{
+				if (first < binned) { density_valid = false; } // a counted point has been overwritten
+				count_descents(first, last, true);
+				pyramid.modified(first, last);
+
+				styles.assign(first, last, s, size());
+				if (s.point_size > 0.0f) { has_markers = true; }
+				if (s.line_width != styles.runs[0].style.line_width) { uniform_line_width = false; }
+				decimated_valid = false;
+				changed = true;
+				// only the new points need to be uploaded
+				vbo.modified_range(first * sizeof(Point2d), last * sizeof(Point2d));
+				if (!colors.empty())
+				{
+					colors.resize(3 * size());
+					for (size_t i = first; i < last; i++) { colors[3 * i] = s.r; colors[3 * i + 1] = s.g; colors[3 * i + 2] = s.b; }
+					color_vbo.modified_range(3 * first * sizeof(float), 3 * last * sizeof(float));
+				}
+				if (transformed_valid)
+				{
+					if (transformed.size() < size()) { transformed.resize(size()); }
+					for (size_t i = first; i < last; i++) { transformed[i] = to_axis((*this)[i]); }
+					transformed_vbo.modified_range(first * sizeof(Point2d), last * sizeof(Point2d));
+				}
+			}
+
+			// stores the point p with the style s at index i (i == size() appends) and keeps the bookkeeping up to date
+			void store(size_t i, const Point2d& p, const Style& s)
+			{
+				if (i < size())
+				{
+					count_descents(i, i + 1, false);
+					(*this)[i] = p;
+				}
+				else
+				{
+					push_back(p);
+				}
+				written(i, i + 1, s);
+			}
+
+			// implicit x values of the bulk plot functions: the index of the sample
+			struct Index { float operator[](size_t i) const { return float(i); } };
+
+			// writes a bulk plot to the recorder
+			template<class YS> void record(const Index&, const YS& ys, size_t count) { recorder->plot(index, static_cast<const Index*>(nullptr), ys, count); }
+			template<class XS, class YS> void record(const XS& xs, const YS& ys, size_t count) { recorder->plot(index, &xs, ys, count); }
+
+			// every stride-th element of an array
+			template<class T> struct Strided
+			{
+				const T* p; size_t stride;
+				const T& operator[](size_t i) const { return p[i * stride]; }
+			};
+
+			// converts the samples [i, i + n) of xs and ys into the points [first, first + n), relative
+			// to the base. with plain pointers this is a simple loop the compiler can vectorize
+			template<class XS, class YS> void convert(size_t first, const XS& xs, const YS& ys, size_t i, size_t n)
+			{
+				Point2d* p = data() + first;
+				const double x0 = origin.x, y0 = origin.y;
+				for (size_t k = 0; k < n; k++)
+				{
+					p[k].x = float(double(xs[i + k]) - x0);
+					p[k].y = float(double(ys[i + k]) - y0);
+				}
+			}
+
+			// check_base() for the samples [i, i + n), using their bounds (nan and inf are skipped)
+			template<class XS, class YS> void check_base(const XS& xs, const YS& ys, size_t i, size_t n)
+			{
+				double x_lo = std::numeric_limits<double>::max(), y_lo = x_lo, x_hi = -x_lo, y_hi = -x_lo;
+				for (size_t k = i; k < i + n; k++)
+				{
+					const double x = double(xs[k]), y = double(ys[k]);
+					if (!std::isfinite(x) || !std::isfinite(y)) { continue; }
+					x_lo = std::min(x_lo, x); x_hi = std::max(x_hi, x);
+					y_lo = std::min(y_lo, y); y_hi = std::max(y_hi, y);
+				}
+				if (x_lo <= x_hi) { check_base(x_lo, y_lo, x_hi, y_hi); }
+			}
+
+			/*
+			*	writes count samples at once: the same result as count calls of plot(x, y), but
+			*	the trace grows at most once and the ringbuffer is written in contiguous segments
+			*	(samples that would be overwritten again within the same call are skipped).
+			*/
+			template<class XS, class YS> void plot_bulk(const XS& xs, const YS& ys, size_t count)
+			{
+				if (recorder) { record(xs, ys, count); }
+				plotted += count;
+				const Style style = current_style();
+				if (MP_NO_SCROLL == scroll)
+				{
+					// a compressed trace grows by a block at a time, so it never holds much more
+					const size_t chunk = history.block_points ? history.block_points : count;
+					for (size_t i = 0; i < count; i += chunk)
+					{
+						const size_t n = std::min(chunk, count - i);
+						check_base(xs, ys, i, n);
+						const size_t first = size();
+						resize(first + n);
+						convert(first, xs, ys, i, n);
+						written(first, first + n, style);
+						seal();
+					}
+					return;
+				}
+
+				const size_t n_max = max_points_to_plot;
+				size_t i = 0;
+				while (i < count)
+				{
+					if (pos >= n_max) { pos = 0; }
+					check_base(xs, ys, i, count - i);
+					size_t n;
+					if (pos < size())
+					{
+						// only the last n_max samples end up in the full ringbuffer
+						if (size() >= n_max && count - i > n_max)
+						{
+							const size_t skip = count - i - n_max;
+							pos = (pos + skip) % n_max;
+							i += skip;
+						}
+						n = std::min(count - i, std::min(size(), n_max) - pos);
+						count_descents(pos, pos + n, false);
+					}
+					else
+					{
+						n = std::min(count - i, n_max - pos);
+						resize(pos + n);
+					}
+					convert(pos, xs, ys, i, n);
+					written(pos, pos + n, style);
+					pos += n;
+					i += n;
+				}
+				if (pos >= n_max) { pos = 0; }
+			}
+
+			/**
+			*	per pixel column min/max decimation: if the x values are non-decreasing and
+			*	several points fall into the same pixel column, each column is reduced to its
+			*	first, minimum, maximum and last point. the line through these points covers
+			*	exactly the same pixels, so the plot looks the same while the number of
+			*	vertices depends on the window width instead of the number of points.
+			*	compressed points come first, see Packed_history::decimate().
+			*	returns false if the trace has to be drawn point by point.
+			*/
+			bool decimate(const Point2d& scale, const Vec2d& offset, double width)
+			{
+				const size_t n = size();
+				const float line_width = history.empty() ? (n ? styles.runs[0].style.line_width : 0.0f) : history.line_width;
+				if (n + history.size() < 64 || has_markers || !uniform_line_width || line_width <= 0 || scale.x <= 0) { return false; }
+
+				update_descents();
+
+				// the ranges that are drawn as one line strip each (see draw())
+				size_t ranges[2][2] = { { 0, n }, { 0, 0 } };
+				bool joined = true; // draw both ranges as one strip
+				if (pos > 0 && pos < n && MP_NO_SCROLL != scroll)
+				{
+					ranges[0][0] = (MP_SCROLL_LEFT == scroll) ? pos : 0;
+					ranges[0][1] = (MP_SCROLL_LEFT == scroll) ? n : pos;
+					ranges[1][0] = (MP_SCROLL_LEFT == scroll) ? 0 : pos;
+					ranges[1][1] = (MP_SCROLL_LEFT == scroll) ? pos : n;
+					joined = (MP_SCROLL_LEFT == scroll);
+					// the points pos-1 and pos are not connected
+					if (descents - descent(pos - 1) > 0) { return false; }
+				}
+				else if (descents > 0 || history.descents > 0)
+				{
+					return false;
+				}
+
+				// only the points in the window and their neighbours. joined ranges only if x is also sorted
+				// across the seam, then a line between the clipped ranges is outside of the window
+				const Point2d* p = vertices();
+				if (window.on && (!joined || ranges[1][1] == 0 || !(p[0].x < p[n - 1].x)))
+				{
+					for (auto& r : ranges) { clip_sorted(r[0], r[1]); }
+				}
+
+				// only worth it if there are clearly more points than pixel columns
+				auto vertex = [this](const Vertex& q, const Vec2d& base) { return to_axis(q, base); };
+				double columns = 0;
+				size_t count = history.size();
+				for (auto& r : ranges)
+				{
+					if (r[1] > r[0]) { columns += (p[r[1] - 1].x - p[r[0]].x) * scale.x; }
+					count += r[1] - r[0];
+				}
+				if (!history.empty())
+				{
+					const Packed_history::Block& first = history.blocks.front();
+					const Packed_history::Block& last = history.blocks.back();
+					const float seam = vertex(last.key[3], last.base).x;
+					if (n > 0 && seam > p[0].x) { return false; }
+					const double span = ((n > 0 ? p[n - 1].x : seam) - vertex(first.key[0], first.base).x) * scale.x;
+					columns += width > 0.0 ? std::min(span, width) : span; // see Packed_history::decimate()
+				}
+				if (double(count) < 4.0 * (columns + 2.0)) { return false; }
+
+				if (decimated_valid && decimated_scale.x == scale.x && decimated_offset.x == offset.x && decimated_width == width) { return true; }
+
+				pyramid.update(data(), n);
+				decimated.clear();
+				if (!history.empty())
+				{
+					decimated.strips.push_back(Decimation::Strip{ 0, 0 });
+					history.decimate(decimated, vertex, scale.x, offset.x, width);
+					decimated.strips.back().count = decimated.points.size();
+				}
+				for (auto& r : ranges)
+				{
+					if (r[1] <= r[0]) { continue; }
+					if (!joined || decimated.strips.empty()) { decimated.strips.push_back(Decimation::Strip{ decimated.points.size(), 0 }); }
+					decimated.range(Styled{ p, styles }, pyramid, r[0], r[1], scale.x, offset.x);
+					decimated.strips.back().count = decimated.points.size() - decimated.strips.back().first;
+				}
+				decimated_valid = true;
+				decimated_scale = scale;
+				decimated_offset = offset;
+				decimated_width = width;
+				lod_vbo.modified = true;
+				return true;
+			}
+
+			// the style of the points that are plotted now
+			Style current_style() const { return Style(cur_col[0], cur_col[1], cur_col[2], cur_line_width, cur_point_size); }
+
+			// returns the point i with its style, for the decimation
+			struct Styled
+			{
+				const Point2d* p;
+				const Style_runs& styles;
+				Vertex operator[](size_t i) const { return Vertex(p[i], styles[i]); }
+			};
+
+			// keeps a color per point while there are many style runs, see many_runs
+			void update_colors()
+			{
+				if (styles.size() <= many_runs)
+				{
+					if (!colors.empty()) { colors = std::vector<float>(); }
+					return;
+				}
+				if (colors.size() == 3 * size()) { return; }
+				colors.resize(3 * size());
+				for (size_t k = 0; k < styles.size(); k++)
+				{
+					const Style& s = styles.runs[k].style;
+					for (size_t i = styles.runs[k].first; i < styles.end(k, size()); i++) { colors[3 * i] = s.r; colors[3 * i + 1] = s.g; colors[3 * i + 2] = s.b; }
+				}
+				color_vbo.modified = true;
+			}
+
+			// draws the line between the points i and j, from the color of i to the color of j.
+			// the line width is set by the caller
+			void draw_seam(size_t i, size_t j)
+			{
+				if (colors.empty())
+				{
+					const Point2d* p = vertices();
+					const Style& a = styles[i];
+					const Style& b = styles[j];
+					glBegin(GL_LINES);
+					glColor3f(a.r, a.g, a.b);
+					glVertex2f(p[i].x, p[i].y);
+					glColor3f(b.r, b.g, b.b);
+					glVertex2f(p[j].x, p[j].y);
+					glEnd();
+				}
+				else
+				{
+					const GLuint seam[2] = { GLuint(i), GLuint(j) };
+					glDrawElements(GL_LINES, 2, GL_UNSIGNED_INT, seam);
+				}
+				count_state();
+				count_draw(2);
+			}
+
+			// draws the lines between the points [first, last) of the trace, one line strip per run of
+			// points with the same color and line width (with a color array: the same line width).
+			// the line from the last point of a run to the next one is drawn on its own if the colors differ.
+			void draw_lines(size_t first, size_t last)
+			{
+				size_t a = first;
+				size_t k = styles.find(first);
+				while (a + 1 < last)
+				{
+					const Style s = styles.runs[k].style;
+					auto same = [&](const Style& t) { return t.line_width == s.line_width && (!colors.empty() || t.same_color(s)); };
+					size_t e = styles.end(k, size());
+					while (e < last && same(styles.runs[k + 1].style)) { k++; e = styles.end(k, size()); }
+					const size_t b = std::min(e, last - 1);
+					const bool blend = b == e && colors.empty() && !styles.runs[k + 1].style.same_color(s);
+					if (s.line_width > 0)
+					{
+						if (colors.empty()) { glColor3f(s.r, s.g, s.b); }
+						glLineWidth(s.line_width);
+						count_state(2);
+						const size_t strip = blend ? b - 1 : b; // the last point of the strip
+						if (strip > a)
+						{
+							glDrawArrays(GL_LINE_STRIP, GLint(a), GLsizei(strip - a + 1));
+							count_draw(strip - a + 1);
+						}
+						if (blend) { draw_seam(b - 1, b); }
+					}
+					a = b;
+					if (b == e) { k++; }
+				}
+			}
+
+			// draws the markers of the points [first, last) of the trace, one batch per run of points with the same style
+			void draw_points(size_t first, size_t last)
+			{
+				size_t a = first;
+				size_t k = styles.find(first);
+				while (a < last)
+				{
+					const Style s = styles.runs[k].style;
+					size_t e = styles.end(k, size());
+					while (e < last && styles.runs[k + 1].style.point_size == s.point_size && (!colors.empty() || styles.runs[k + 1].style.same_color(s))) { k++; e = styles.end(k, size()); }
+					const size_t b = std::min(e, last);
+					if (s.point_size > 0.0f)
+					{
+						if (colors.empty()) { glColor3f(s.r, s.g, s.b); }
+						glPointSize(s.point_size);
+						glDrawArrays(GL_POINTS, GLint(a), GLsizei(b - a));
+						count_state(2);
+						count_draw(b - a);
+					}
+					a = b;
+					k++;
+				}
+			}
+
+			// draws the lines between the points [first, last) of p as line strips.
+			// reduce number of opengl state changes: a new strip is only started if the line_width changes.
+			static void draw_lines(const Vertex* p, size_t first, size_t last)
+			{
+				size_t a = first;
+				while (a + 1 < last)
+				{
+					const float line_width = p[a].line_width;
+					size_t b = a + 1;
+					while (b + 1 < last && p[b].line_width == line_width) { b++; }
+					if (line_width > 0)
+					{
+						glLineWidth(line_width);
+						glDrawArrays(GL_LINE_STRIP, GLint(a), GLsizei(b - a + 1));
+						count_state();
+						count_draw(b - a + 1);
+					}
+					a = b;
+				}
+			}
+
+			// draws the markers / points [first, last) of p
+			static void draw_points(const Vertex* p, size_t first, size_t last)
+			{
+				size_t a = first;
+				while (a < last)
+				{
+					const float point_size = p[a].point_size;
+					size_t b = a + 1;
+					while (b < last && p[b].point_size == point_size) { b++; }
+					if (point_size > 0.0f)
+					{
+						glPointSize(point_size);
+						glDrawArrays(GL_POINTS, GLint(a), GLsizei(b - a));
+						count_state();
+						count_draw(b - a);
+					}
+					a = b;
+				}
+			}
+
+			// counts the points that are not in the density map yet (all of them if the scaling has
+			// changed) and draws the map
+			void draw_density(const Point2d& scale, const Vec2d& local, double width, double height)
+			{
+				const unsigned int w = (unsigned int)std::max(0.0, width), h = (unsigned int)std::max(0.0, height);
+				auto add = [&](const Point2d& v) { density_map.add((v.x - local.x) * scale.x, (v.y - local.y) * scale.y); };
+				if (!density_valid || w != density_map.width() || h != density_map.height() || scale.x != density_scale.x || scale.y != density_scale.y || local.x != density_offset.x || local.y != density_offset.y)
+				{
+					density_map.reset(w, h);
+					std::vector<Vertex> block;
+					for (size_t k = 0; k < history.blocks.size(); k++)
+					{
+						history.decode(k, block);
+						for (const Vertex& q : block) { add(to_axis(Point2d(q.x, q.y), history.blocks[k].base)); }
+					}
+					binned = 0;
+					density_valid = true;
+					density_scale = scale;
+					density_offset = local;
+				}
+				const Point2d* p = vertices();
+				for (size_t i = binned; i < size(); i++) { add(p[i]); }
+				binned = size();
+
+				glPushMatrix();
+				glLoadIdentity(); // the map is in window coordinates
+				density_map.draw(cur_col[0], cur_col[1], cur_col[2], density_log);
+				glPopMatrix();
+				count_state();
+				count_draw(density_map.vertices());
+			}
+
+			/**
+			*	draws the compressed points if the trace can't be decimated. the blocks are decoded
+			*	one by one and drawn together with the first uncompressed point, which continues the
+			*	line. blocks outside of the window only add their last point (for that line).
+			*/
+			void draw_history(const Point2d& scale, const Vec2d& offset, double width)
+			{
+				const double x_min = offset.x, x_max = width > 0.0 ? offset.x + width / scale.x : std::numeric_limits<double>::max();
+				std::vector<Vertex> points, block;
+				auto draw = [&](size_t markers)
+				{
+					const char* base = history_vbo.bind(points.data(), points.size() * sizeof(Vertex));
+					history_vbo.modified = true;
+					glEnableClientState(GL_VERTEX_ARRAY);
+					glEnableClientState(GL_COLOR_ARRAY);
+					glVertexPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, x));
+					glColorPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, r));
+					count_state(2);
+					draw_lines(points.data(), 0, points.size());
+					draw_points(points.data(), 0, markers);
+				};
+				for (size_t k = 0; k < history.blocks.size(); k++)
+				{
+					const Packed_history::Block& b = history.blocks[k];
+					if (to_axis(Point2d(b.x_max, 0.0f), b.base).x < x_min || to_axis(Point2d(b.x_min, 0.0f), b.base).x > x_max)
+					{
+						points.push_back(to_axis(b.key[3], b.base));
+					}
+					else
+					{
+						history.decode(k, block);
+						for (const Vertex& q : block) { points.push_back(to_axis(q, b.base)); }
+					}
+					// the last point is drawn again as the start of the next batch
+					if (points.size() >= history.block_points)
+					{
+						draw(points.size() - 1);
+						points.erase(points.begin(), points.end() - 1);
+					}
+				}
+				const size_t markers = points.size();
+				if (!empty()) { points.push_back(Vertex(vertices()[0], styles[0])); }
+				draw(markers);
+			}
+
+		public:
+
+			/**
+			*	plot a point at (x,y) to the currently active trace. 
+			*	you may switch the trace with a call to trace(int _trace)
+			*/
+			void plot(const double x, const double y)
+			{ 
+				check_base(x, y);
+				const Point2d p(float(x - origin.x), float(y - origin.y));
+				plotted++;
+				if (recorder)
+				{
+					if (double(float(x)) == x && double(float(y)) == y) { recorder->op(index, Session_recorder::OP_PLOT); recorder->f(float(x)); recorder->f(float(y)); }
+					else { recorder->op(index, Session_recorder::OP_PLOT_DOUBLE); recorder->d(x); recorder->d(y); }
+				}
+
+				if(MP_NO_SCROLL != scroll)
+				{
+					// this implements a simple ringbuffer
+					store(pos, p, current_style());
+					pos++;
+
+					if(pos >= max_points_to_plot){ pos = 0; }		
+				}
+				else
+				{
+					store(size(), p, current_style());
+					seal();
+				}
+			}
+
+			/**
+			*	plots count values of the array y, taking every stride-th element.
+			*	the x value is running from 0 .. count-1
+			*/
+			template<class T> void plot(const T* y, size_t count, size_t stride = 1)
+			{
+				if (stride == 1) { plot_bulk(Index(), y, count); }
+				else { plot_bulk(Index(), Strided<T>{ y, stride }, count); }
+			}
+
+			/**
+			*	plots count points of the arrays x and y, taking every stride_x-th
+			*	element of x and every stride_y-th element of y.
+			*/
+			template<class T> void plot(const T* x, const T* y, size_t count, size_t stride_x = 1, size_t stride_y = 1)
+			{
+				if (stride_x == 1 && stride_y == 1) { plot_bulk(x, y, count); }
+				else { plot_bulk(Strided<T>{ x, stride_x }, Strided<T>{ y, stride_y }, count); }
+			}
+
+			/**
+			*	plots the values of the random access range [first, last).
+			*	the x value is running from 0 .. last-first-1
+			*/
+			template<class It> void plot_range(It first, It last)
+			{
+				plot_bulk(Index(), first, size_t(std::distance(first, last)));
+			}
+
+			/**
+			*	plots the points with x values from the random access range [x_first, x_last)
+			*	and y values from the range of the same length starting at y_first.
+			*/
+			template<class XIt, class YIt> void plot_range(XIt x_first, XIt x_last, YIt y_first)
+			{
+				plot_bulk(x_first, y_first, size_t(std::distance(x_first, x_last)));
+			}
+
+			/**
+			*	call modified() if you changed points directly through the std::vector
+			*	interface of the trace, so the copy on the graphics card gets updated.
+			*	points that have been added this way get the style of the last point.
+			*/
+			void modified()
+			{
+				changed = true;
+				vbo.modified = true;
+				pyramid.modified();
+				descents_valid = false;
+				decimated_valid = false;
+				transformed_valid = false;
+				density_valid = false;
+				colors = std::vector<float>();
+				styles.resize(size(), current_style());
+				has_markers = false;
+				uniform_line_width = true;
+				for (const Style_runs::Run& r : styles.runs)
+				{
+					if (r.style.point_size > 0.0f) { has_markers = true; }
+					if (r.style.line_width != styles.runs[0].style.line_width) { uniform_line_width = false; }
+				}
+				if (!history.empty())
+				{
+					if (history.markers) { has_markers = true; }
+					if (!history.uniform || (!empty() && styles.runs[0].style.line_width != history.line_width)) { uniform_line_width = false; }
+				}
+			}
+
+			/**
+			*	keeps long traces small in memory: as points get older, they are sealed in blocks of
+			*	block_points and compressed, only the newest one or two blocks stay as they are.
+			*	this is lossless, a quantum > 0 rounds y to multiples of the quantum, which compresses
+			*	noisy signals much better. slowly changing signals take about 3 bytes per point
+			*	instead of 8. a block is decoded only when a frame needs its points: if it is zoomed
+			*	into, or if the trace can't be decimated (points, varying line widths, x going back).
+			*	the std::vector interface of the trace then holds the uncompressed points only,
+			*	count() returns the number of all points. traces that scroll are not compressed.
+			*	block_points = 0 switches compression off, sealed points stay compressed.
+			*/
+			void compression(size_t block_points = 4096, double quantum = 0.0)
+			{
+				if (block_points > 0 && (block_points < Lod_pyramid::block || block_points > (size_t(1) << 24))) { throw("error calling Multiplot::compression(): a block must have between 64 and 16777216 points."); }
+				history.block_points = block_points;
+				history.quantum = quantum > 0.0 ? quantum : 0.0;
+				seal();
+			}
+
+			/**
+			*	the number of points of the trace, including the compressed ones (see compression()).
+			*/
+			size_t count() const { return history.size() + size(); }
+
+			/**
+			*	the memory used by the points of the trace in bytes, compressed and uncompressed.
+			*/
+			size_t memory() const { return capacity() * sizeof(Point2d) + styles.runs.capacity() * sizeof(Style_runs::Run) + colors.capacity() * sizeof(float) + history.bytes(); }
+
+			/**
+			*	for scatter plots with many points: instead of a marker per point, the points are
+			*	counted per pixel of the window and drawn as one image, from a dark shade of the
+			*	current color of the trace for few points over the color to white for the most points.
+			*	log_scale shades by the logarithm of the count, so single points stay visible next to
+			*	dense clusters. appended points are counted incrementally, a change of the scaling
+			*	counts all points again. the cost of a frame depends on the size of the window, not on
+			*	the number of points. no lines are drawn in this mode.
+			*/
+			void density(bool on = true, bool log_scale = true)
+			{
+				if (recorder) { recorder->op(index, Session_recorder::OP_DENSITY); recorder->varint(uint32_t(on) | uint32_t(log_scale) << 1); }
+				density_on = on;
+				density_log = log_scale;
+				density_valid = false;
+				changed = true;
+			}
+
+			/**
+			*	sets the current drawing color in rgb format. 
+			*   r,g,b are in the range [0..1]
+			*/
+			void color3f(float r, float g, float b)
+			{
+				cur_col[0]=r;
+				cur_col[1]=g;
+				cur_col[2]=b;
+				if (density_on) { changed = true; } // the color of the density map
+				if (recorder) { recorder->op(index, Session_recorder::OP_COLOR); recorder->f(r); recorder->f(g); recorder->f(b); }
+			}
+
+			/**
+			*	call linewidth to change the thickness of the traces. the default
+			*	value is 1 pixel, if you set the linewidth to zero, no lines are drawn. this
+			*	is usefull to create scatter-plots.
+			*/
+			void linewidth(float width)
+			{
+				cur_line_width=width;
+				if (recorder) { recorder->op(index, Session_recorder::OP_LINEWIDTH); recorder->f(width); }
+			}
+
+			/**
+			*	this function sets the size of the plot-points. the default value is zero, so 
+			*	no points are drawn at all. if you wish to create a scatter-plot, set the pointsize
+			*  to a value bigger than zero and the linesize to zero.
+			*/
+			void pointsize(float psize)
+			{
+				cur_point_size = psize;
+				if (recorder) { recorder->op(index, Session_recorder::OP_POINTSIZE); recorder->f(psize); }
+			}
+
+
+			/**
+			*	if you call scrolling with a positive number of points to be plotted,
+			*	your graph will scroll left out of the plot-window as you add new plot-points beyond number_of_points_to_plot_.
+			*	Zero or a negative number disables scrolling.
+			*/
+			void scrolling(MP_SCROLLING scrolling_type_, int number_of_points_to_plot_ = -1)
+			{
+				if (MP_NO_SCROLL != scrolling_type_ && number_of_points_to_plot_ <= 0) { throw("error calling Multiplot::scrolling(): The number of points to plot must be a positive integer greater zero."); }
+				if (MP_NO_SCROLL != scrolling_type_ && !history.empty()) { throw("error calling Multiplot::scrolling(): a trace with compressed points can not scroll, clear() it first."); }
+				if (recorder)
+				{
+					recorder->op(index, Session_recorder::OP_SCROLLING);
+					recorder->varint(scrolling_type_);
+					recorder->varint(uint32_t(number_of_points_to_plot_ < 0 ? 0 : number_of_points_to_plot_));
+				}
+				scroll = scrolling_type_;
+				max_points_to_plot = number_of_points_to_plot_;
+				changed = true;
+
+				if(max_points_to_plot <= 0)
+				{
+					scroll=MP_NO_SCROLL;
+					return;
+				}
+			}
+
+			/**
+			*	clear() removes all points from the trace.
+			*	the trace is empty afterwards and can be filled
+			*	with plot(x,y) again.
+			*/
+			void clear()
+			{
+				std::vector<Point2d>::clear(); pos=0; history.clear(); modified();
+				rebase_limit = Vec2d(-1.0, -1.0); // the next point chooses the base
+				if (recorder) { recorder->op(index, Session_recorder::OP_CLEAR); }
+			}
+		};
+
+		/**
+		*	class Trace_view draws samples that stay in memory owned by the caller: a view
+		*	refers to an array of y values (any MP_DTYPE, with a stride) and an optional array
+		*	of x values. without x values, x is the index of the sample. nothing is copied,
+		*	so the array must stay valid as long as the view refers to it. after changing
+		*	samples, call updated(first, last), so the view and its bounds are refreshed.
+		*/
+		class Trace_view
+		{
+		public:
+			bool changed = true; // true if the view looks different since it was drawn last
+
+			/**
+			*	refers to count values of the array y, taking every stride-th element.
+			*	x is running from 0 .. count-1
+			*/
+			template<class T> void data(const T* y, size_t count, size_t stride = 1)
+			{
+				data(nullptr, y, dtype_of<T>(), count, 0, stride * sizeof(T));
+			}
+
+			/**
+			*	refers to count points of the arrays x and y, taking every stride_x-th
+			*	element of x and every stride_y-th element of y.
+			*/
+			template<class T> void data(const T* x, const T* y, size_t count, size_t stride_x = 1, size_t stride_y = 1)
+			{
+				data(x, y, dtype_of<T>(), count, stride_x * sizeof(T), stride_y * sizeof(T));
+			}
+
+			/**
+			*	refers to count samples of type type. the strides are in bytes and x may be
+			*	nullptr to use the index of the sample as x.
+			*/
+			void data(const void* x, const void* y, MP_DTYPE type, size_t count, size_t stride_x_bytes, size_t stride_y_bytes)
+			{
+				xs = Channel{ static_cast<const char*>(x), stride_x_bytes, type };
+				ys = Channel{ static_cast<const char*>(y), stride_y_bytes, type };
+				n = y ? count : 0;
+				// large values are drawn relative to the first sample, like the points of a Trace
+				const double x0 = (n && x) ? xs.value(0) : 0.0, y0 = n ? ys.value(0) : 0.0;
+				origin = Vec2d(std::isfinite(x0) && std::fabs(x0) >= 65536.0 ? x0 : 0.0, std::isfinite(y0) && std::fabs(y0) >= 65536.0 ? y0 : 0.0);
+				file.reset();
+				loader.reset();
+				updated();
+			}
+
+			/**
+			*	draws one channel of a binary file without reading it into memory. the file is
+			*	mapped, and only the pages needed for the current frame are read from disk.
+			*	a .npy file (numpy, 1 or 2 dimensions) describes its own type and channels,
+			*	for a raw file pass the element type, the number of channels, whether they are
+			*	interleaved (c0 c1 c2 c0 c1 c2 ...) or stored one after another, and the size of a
+			*	header to skip. while the pyramid over the samples is built in the background,
+			*	a coarse preview of the file is drawn, so the first frame is shown immediately.
+			*/
+			void open_file(const std::string& filename, size_t channel = 0, MP_DTYPE type = MP_FLOAT, size_t channels = 1, bool interleaved = true, size_t header_bytes = 0)
+			{
+				std::shared_ptr<Mapped_file> f = std::make_shared<Mapped_file>(filename);
+				size_t count = 0;
+				if (!parse_npy(f->data(), f->size(), type, channels, count, interleaved, header_bytes))
+				{
+					if (channels == 0 || header_bytes > f->size()) { throw std::runtime_error("Multiplot: invalid layout of " + filename); }
+					count = (f->size() - header_bytes) / (channels * dtype_size(type));
+				}
+				if (channel >= channels) { throw std::out_of_range("Multiplot: " + filename + " has no channel " + std::to_string(channel)); }
+
+				const size_t size = dtype_size(type);
+				const char* y = f->data() + header_bytes + (interleaved ? channel * size : channel * count * size);
+				data(nullptr, count ? y : nullptr, type, count, 0, interleaved ? channels * size : size);
+				file = f;
+
+				// build the pyramid in a thread that owns everything it touches
+				std::shared_ptr<Loader> l = std::make_shared<Loader>();
+				loader = l;
+				const Points p = points();
+				std::thread([l, p, f, count]() { l->pyramid.update(p, count); l->done = true; }).detach();
+			}
+
+			// the number of samples the view refers to
+			size_t size() const { return n; }
+
+			/**
+			*	changes the number of samples, e.g. while a preallocated array is filled.
+			*	the array must hold at least count samples.
+			*/
+			void resize(size_t count)
+			{
+				if (count < n) { n = count; updated(); return; }
+				const size_t old = n;
+				n = count;
+				updated(old > 0 ? old - 1 : 0, n);
+			}
+
+			/**
+			*	call updated() after the samples [first, last) have been changed.
+			*/
+			void updated(size_t first, size_t last)
+			{
+				last = std::min(last, n);
+				if (first >= last) { return; }
+				pyramid.modified(first, last);
+				if (xs.p) // with the index as x, there are no descents
+				{
+					const size_t blocks = (n + Lod_pyramid::block - 1) / Lod_pyramid::block;
+					if (block_descents.size() != blocks) { block_descents.resize(blocks, 0); }
+					// the descent between first-1 and first is counted in the block of first-1
+					for (size_t b = (first > 0 ? first - 1 : 0) / Lod_pyramid::block; b <= (last - 1) / Lod_pyramid::block; b++)
+					{
+						descents_dirty.push_back(b);
+					}
+				}
+				decimated_valid = false;
+				changed = true;
+			}
+
+			/**
+			*	call updated() after samples anywhere in the array have been changed.
+			*/
+			void updated()
+			{
+				pyramid.clear();
+				block_descents.clear();
+				descents_dirty.clear();
+				descents = 0;
+				updated(0, n);
+			}
+
+			/**
+			*	sets the color of the view in rgb format. r,g,b are in the range [0..1]
+			*/
+			void color3f(float r, float g, float b) { col[0] = r; col[1] = g; col[2] = b; changed = true; decimated_valid = false; }
+
+			/**
+			*	sets the thickness of the lines. with zero, no lines are drawn.
+			*/
+			void linewidth(float width) { line_width = width; changed = true; decimated_valid = false; }
+
+			/**
+			*	sets the size of the points. with zero (the default), no points are drawn.
+			*/
+			void pointsize(float psize) { point_size = psize; changed = true; }
+
+			bool has_buffers() const { return lod_vbo.id != 0; }
+
+			/**
+			*	true if the pyramid of a file opened with open_file() has been built, but the view
+			*	has not been drawn with it yet. check() redraws the window then.
+			*/
+			bool loaded() const { return loader && loader->done; }
+
+			/**
+			*	frees the buffers on the graphics card. the gl context must be current.
+			*	use context_alive = false if the context has already been destroyed.
+			*/
+			void release_buffers(bool context_alive = true) { lod_vbo.release(context_alive); }
+
+			/**
+			*	returns the bounding box of all samples of this view.
+			*	returns false if the view is empty.
+			*/
+			bool bounds(double& x_min, double& y_min, double& x_max, double& y_max)
+			{
+				if (n == 0) { return false; }
+				const Points p = points();
+				if (loading())
+				{
+					// estimate the bounds from the samples of the preview
+					const size_t step = preview_step();
+					x_min = x_max = p.x(0);
+					y_min = y_max = p.y(0);
+					for (size_t i = 0; ; i = std::min(i + step, n - 1))
+					{
+						const float x = p.x(i), y = p.y(i);
+						if (x < x_min) { x_min = x; }
+						if (x > x_max) { x_max = x; }
+						if (y < y_min) { y_min = y; }
+						if (y > y_max) { y_max = y; }
+						if (i == n - 1) { break; }
+					}
+				}
+				else
+				{
+					pyramid.update(p, n);
+					const Lod_pyramid::Node& root = pyramid.levels.back()[0];
+					x_min = p.x(root.i_xmin);
+					x_max = p.x(root.i_xmax);
+					y_min = p.y(root.i_min);
+					y_max = p.y(root.i_max);
+				}
+				x_min += origin.x; x_max += origin.x;
+				y_min += origin.y; y_max += origin.y;
+				if (!xs.p) { x_min = 0.0; x_max = double(n - 1); } // exact, also beyond 2^24 samples
+				return true;
+			}
+
+			/**
+			*	extends minimum / maximum such that all samples of this view are enclosed.
+			*/
+			void extend_bounds(Vec2d& minimum, Vec2d& maximum)
+			{
+				double x_min, y_min, x_max, y_max;
+				if (!bounds(x_min, y_min, x_max, y_max)) { return; }
+				if (x_max > maximum.x)maximum.x = x_max;
+				if (y_max > maximum.y)maximum.y = y_max;
+				if (x_min < minimum.x)minimum.x = x_min;
+				if (y_min < minimum.y)minimum.y = y_min;
+			}
+
+			/**
+			*	draws the view like Trace::draw(). if there are many samples per pixel column,
+			*	only the decimated view is converted to vertices, otherwise the samples are
+			*	converted into a small vertex array piece by piece.
+			*/
+			void draw(const Point2d& scale, const Vec2d& offset, const Axis_transform& axes = Axis_transform())
+			{
+				if (n == 0) { return; }
+				// an index as x is drawn relative to the left edge of the window, so neighbouring
+				// samples stay apart beyond 2^24 samples
+				Points q = points();
+				if (!xs.p && !axes.log_x) { q.base.x = std::floor(std::min(std::max(offset.x, 0.0), double(n - 1))); }
+				const Axis_points p{ q, axes };
+
+				// see Trace::draw()
+				const Vec2d local(axes.log_x ? offset.x : offset.x - q.base.x, axes.log_y ? offset.y : offset.y - q.base.y);
+				glPushMatrix();
+				glTranslatef(float(-local.x), float(-local.y), 0.0f);
+				count_state();
+
+				glEnableClientState(GL_VERTEX_ARRAY);
+				glEnableClientState(GL_COLOR_ARRAY);
+				if (loading())
+				{
+					// every step-th sample, until the pyramid is ready
+					const size_t step = preview_step();
+					vertices.clear();
+					for (size_t i = 0; i < n; i += step) { vertices.push_back(p[i]); }
+					if ((n - 1) % step) { vertices.push_back(p[n - 1]); }
+					Vertex_buffer::unbind();
+					glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].x);
+					glColorPointer(3, GL_FLOAT, sizeof(Vertex), &vertices[0].r);
+					count_state(2);
+					if (line_width > 0)
+					{
+						glLineWidth(line_width);
+						glDrawArrays(GL_LINE_STRIP, 0, GLsizei(vertices.size()));
+						count_state();
+						count_draw(vertices.size());
+					}
+					if (point_size > 0)
+					{
+						glPointSize(point_size);
+						glDrawArrays(GL_POINTS, 0, GLsizei(vertices.size()));
+						count_state();
+						count_draw(vertices.size());
+					}
+				}
+				else if (decimate(q, scale, local, axes))
+				{
+					const char* base = lod_vbo.bind(decimated.points.data(), decimated.points.size() * sizeof(Vertex));
+					glVertexPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, x));
+					glColorPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, r));
+					glLineWidth(line_width);
+					count_state(3);
+					for (const Decimation::Strip& s : decimated.strips)
+					{
+						glDrawArrays(GL_LINE_STRIP, GLint(s.first), GLsizei(s.count));
+						count_draw(s.count);
+					}
+					Vertex_buffer::unbind();
+				}
+				else
+				{
+					// consecutive pieces share one point, so their line strips are connected
+					Vertex_buffer::unbind();
+					const size_t piece = 65536;
+					for (size_t first = 0; first < n; first += piece - 1)
+					{
+						const size_t last = std::min(n, first + piece);
+						vertices.resize(last - first);
+						for (size_t i = first; i < last; i++) { vertices[i - first] = p[i]; }
+						glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].x);
+						glColorPointer(3, GL_FLOAT, sizeof(Vertex), &vertices[0].r);
+						count_state(2);
+						if (line_width > 0)
+						{
+							glLineWidth(line_width);
+							glDrawArrays(GL_LINE_STRIP, 0, GLsizei(last - first));
+							count_state();
+							count_draw(last - first);
+						}
+						if (point_size > 0)
+						{
+							const GLint skip = first > 0 ? 1 : 0; // drawn with the previous piece
+							glPointSize(point_size);
+							glDrawArrays(GL_POINTS, skip, GLsizei(last - first - skip));
+							count_state();
+							count_draw(last - first - skip);
+						}
+						if (last == n) { break; }
+					}
+				}
+				glDisableClientState(GL_COLOR_ARRAY);
+				glDisableClientState(GL_VERTEX_ARRAY);
+				glPopMatrix();
 			}
 
 			/**
-			*	call linewidth to change the thickness of the traces. the default
-			*	value is 1 pixel, if you set the linewidth to zero, no lines are drawn. this
-			*	is usefull to create scatter-plots.
+			*	the samples are drawn relative to base(), see Trace::base(). it is chosen by
+			*	the first sample when data() or open_file() is called. an index as x is drawn
+			*	relative to the left edge of the window instead.
 			*/
-			void linewidth(float width){ cur_line_width=width; }
+			Vec2d base() const { return origin; }
 
-			/**
-			*	this function sets the size of the plot-points. the default value is zero, so 
-			*	no points are drawn at all. if you wish to create a scatter-plot, set the pointsize
-			*  to a value bigger than zero and the linesize to zero.
-			*/
-			void pointsize(float psize){ cur_point_size = psize; }
+		protected:
+			// one array of samples
+			struct Channel
+			{
+				const char* p = nullptr;
+				size_t stride = 0;		// in bytes
+				MP_DTYPE type = MP_FLOAT;
+
+				float operator[](size_t i) const
+				{
+					const char* e = p + i * stride;
+					switch (type)
+					{
+					case MP_INT8:	return float(*reinterpret_cast<const int8_t*>(e));
+					case MP_UINT8:	return float(*reinterpret_cast<const uint8_t*>(e));
+					case MP_INT16:	return float(*reinterpret_cast<const int16_t*>(e));
+					case MP_UINT16:	return float(*reinterpret_cast<const uint16_t*>(e));
+					case MP_INT32:	return float(*reinterpret_cast<const int32_t*>(e));
+					case MP_UINT32:	return float(*reinterpret_cast<const uint32_t*>(e));
+					case MP_INT64:	return float(*reinterpret_cast<const int64_t*>(e));
+					case MP_UINT64:	return float(*reinterpret_cast<const uint64_t*>(e));
+					case MP_FLOAT:	return *reinterpret_cast<const float*>(e);
+					case MP_DOUBLE:	return float(*reinterpret_cast<const double*>(e));
+					}
+					return 0.0f;
+				}
+
+				// the sample i in full precision
+				double value(size_t i) const
+				{
+					const char* e = p + i * stride;
+					switch (type)
+					{
+					case MP_INT64:	return double(*reinterpret_cast<const int64_t*>(e));
+					case MP_UINT64:	return double(*reinterpret_cast<const uint64_t*>(e));
+					case MP_DOUBLE:	return *reinterpret_cast<const double*>(e);
+					default:		return (*this)[i];
+					}
+				}
+			};
+
+			// returns the sample i as a point with the style of the view, relative to the base,
+			// for the pyramid and the decimation
+			struct Points
+			{
+				Channel xs, ys;
+				Vertex style;
+				Vec2d base;
+				bool exact; // the samples are no larger than floats, relative to a base of 0
+				float x(size_t i) const
+				{
+					if (!xs.p) { return float(double(i) - base.x); }
+					return exact ? xs[i] : float(xs.value(i) - base.x);
+				}
+				float y(size_t i) const { return exact ? ys[i] : float(ys.value(i) - base.y); }
+				Vertex operator[](size_t i) const { Vertex p = style; p.x = x(i); p.y = y(i); return p; }
+			};
+			Points points() const
+			{
+				const bool exact = origin.x == 0.0 && origin.y == 0.0 && xs.type != MP_INT64 && xs.type != MP_UINT64 && xs.type != MP_DOUBLE;
+				return Points{ xs, ys, Vertex(0, 0, col[0], col[1], col[2], line_width, point_size), origin, exact };
+			}
+
+			// the samples in axis coordinates, for drawing: on a logarithmic axis log10 of base + sample
+			struct Axis_points
+			{
+				Points p;
+				Axis_transform axes;
+				Vertex operator[](size_t i) const
+				{
+					Vertex q = p[i];
+					if (axes.log_x) { q.x = Axis_transform::log(p.base.x + q.x); }
+					if (axes.log_y) { q.y = Axis_transform::log(p.base.y + q.y); }
+					return q;
+				}
+			};
+
+			static size_t dtype_size(MP_DTYPE type)
+			{
+				switch (type)
+				{
+				case MP_INT8: case MP_UINT8: return 1;
+				case MP_INT16: case MP_UINT16: return 2;
+				case MP_INT32: case MP_UINT32: case MP_FLOAT: return 4;
+				default: return 8;
+				}
+			}
+
+			// reads the header of a .npy file. returns false if p is not a .npy file
+			static bool parse_npy(const char* p, size_t size, MP_DTYPE& type, size_t& channels, size_t& count, bool& interleaved, size_t& header_bytes)
+			{
+				if (size < 10 || std::string(p, 6) != "\x93NUMPY") { return false; }
+				const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+				if (u[6] != 1 && size < 12) { throw std::runtime_error("Multiplot: truncated .npy header"); }
+				const size_t len = u[6] == 1 ? size_t(u[8]) | size_t(u[9]) << 8 : size_t(u[8]) | size_t(u[9]) << 8 | size_t(u[10]) << 16 | size_t(u[11]) << 24;
+				const size_t start = u[6] == 1 ? 10 : 12;
+				if (start + len > size) { throw std::runtime_error("Multiplot: truncated .npy header"); }
+				const std::string h(p + start, len);
+
+				// the header is a python dict: {'descr': '<f4', 'fortran_order': False, 'shape': (1000, 2), }
+				const size_t d = h.find("'descr'");
+				const size_t c = d == std::string::npos ? d : h.find(':', d);
+				const size_t q = c == std::string::npos ? c : h.find('\'', c + 1);
+				const std::string descr = q == std::string::npos ? "" : h.substr(q + 1, 3);
+				if (descr.size() != 3) { throw std::runtime_error("Multiplot: unsupported .npy type " + descr); }
+				const char* names[] = { "i1", "u1", "i2", "u2", "i4", "u4", "i8", "u8", "f4", "f8" };
+				int t = 0;
+				while (t < 10 && descr.substr(1) != names[t]) { t++; }
+				if (t == 10 || descr[0] == '>' || (descr[0] == '|' && t > 1)) { throw std::runtime_error("Multiplot: unsupported .npy type " + descr); }
+				type = MP_DTYPE(t);
+
+				interleaved = h.find("'fortran_order': False") != std::string::npos;
+				const size_t s = h.find('(', h.find("'shape'"));
+				std::vector<size_t> shape;
+				for (size_t i = s + 1; s != std::string::npos && i < h.size() && h[i] != ')'; i++)
+				{
+					if (h[i] >= '0' && h[i] <= '9')
+					{
+						shape.push_back(std::stoull(h.substr(i)));
+						while (i + 1 < h.size() && h[i + 1] >= '0' && h[i + 1] <= '9') { i++; }
+					}
+				}
+				if (shape.empty() || shape.size() > 2) { throw std::runtime_error("Multiplot: only .npy files with 1 or 2 dimensions are supported"); }
+				count = shape[0];
+				channels = shape.size() == 2 ? shape[1] : 1;
+				header_bytes = start + len;
+				if (header_bytes + count * channels * dtype_size(type) > size) { throw std::runtime_error("Multiplot: truncated .npy file"); }
+				return true;
+			}
+
+			Channel xs, ys;
+			size_t n = 0;
+			float col[3]{ 1.0f, 1.0f, 1.0f };
+			float line_width = 1.0f;
+			float point_size = 0.0f;
+
+			// number of decreasing x values, counted per block of the pyramid, so that
+			// updated() only has to recount the changed blocks
+			std::vector<size_t> block_descents;
+			std::vector<size_t> descents_dirty;
+			size_t descents = 0;
+
+			Lod_pyramid pyramid;
+			Decimation decimated;
+			Vertex_buffer lod_vbo;
+			bool decimated_valid = false;
+			Point2d decimated_scale;
+			Vec2d decimated_offset;
+			double decimated_base = 0.0;	// the x of the base the decimation is relative to, see draw()
+			Axis_transform decimated_axes;
+			Vec2d origin; // see base()
+			std::vector<Vertex> vertices; // the piece of the view that is drawn point by point
+
+			// a file opened with open_file() and the pyramid that is built for it in the background
+			struct Loader
+			{
+				Lod_pyramid pyramid;
+				std::atomic<bool> done{ false };
+			};
+			std::shared_ptr<Mapped_file> file;
+			std::shared_ptr<Loader> loader;
+
+			// the preview shows about 4096 samples. each one is usually on a different page of
+			// the file, so more samples would make the first frame wait for the disk.
+			size_t preview_step() const { return std::max(size_t(1), n / 4096); }
+
+			// true while the pyramid is built. takes over the pyramid as soon as it is ready
+			bool loading()
+			{
+				if (!loader) { return false; }
+				if (!loader->done) { return true; }
+				pyramid = std::move(loader->pyramid);
+				loader.reset();
+				return false;
+			}
+
+			void count_descents()
+			{
+				std::sort(descents_dirty.begin(), descents_dirty.end());
+				descents_dirty.erase(std::unique(descents_dirty.begin(), descents_dirty.end()), descents_dirty.end());
+				for (size_t b : descents_dirty)
+				{
+					if (b >= block_descents.size()) { continue; }
+					size_t d = 0;
+					const size_t last = std::min(n - 1, (b + 1) * Lod_pyramid::block);
+					float x = xs[b * Lod_pyramid::block];
+					for (size_t i = b * Lod_pyramid::block; i < last; i++)
+					{
+						const float next = xs[i + 1];
+						d += !(next >= x); // nan counts as well
+						x = next;
+					}
+					descents += d - block_descents[b];
+					block_descents[b] = d;
+				}
+				descents_dirty.clear();
+			}
+
+			// reduces the view to a few points per pixel column, see Trace::decimate().
+			// returns false if the view has to be drawn point by point.
+			bool decimate(const Points& p, const Point2d& scale, const Vec2d& offset, const Axis_transform& axes)
+			{
+				if (n < 64 || point_size > 0 || line_width <= 0 || scale.x <= 0) { return false; }
+				count_descents();
+				if (descents > 0) { return false; }
+
+				const Axis_points ap{ p, axes };
+				const double columns = (ap[n - 1].x - ap[0].x) * scale.x;
+				if (double(n) < 4.0 * (columns + 2.0)) { return false; }
+
+				if (decimated_valid && decimated_scale.x == scale.x && decimated_offset.x == offset.x && decimated_base == p.base.x && decimated_axes == axes) { return true; }
+
+				// the transform is monotonic, so the pyramid over the samples also serves the transformed ones
+				pyramid.update(p, n);
+				decimated.clear();
+				decimated.strips.push_back(Decimation::Strip{ 0, 0 });
+				decimated.range(ap, pyramid, 0, n, scale.x, offset.x);
+				decimated.strips.back().count = decimated.points.size();
+				decimated_valid = true;
+				decimated_scale = scale;
+				decimated_offset = offset;
+				decimated_base = p.base.x;
+				decimated_axes = axes;
+				lod_vbo.modified = true;
+				return true;
+			}
+		};
+
+
+		virtual ~Multiplot()
+		{
+			render_thread(0); // stop the render thread
+			windows().erase(std::remove(windows().begin(), windows().end(), this), windows().end());
+			#ifdef MULTIPLOT_FLTK
+			Fl::remove_timeout(rest_timeout, this);
+			#endif
+			release_buffers();
+			hide(); check();
+			delete queue.load();
+		}
+        
+		Multiplot(const int x,const int y,const int w,const int h, const std::wstring& title_str_=L"www.andre-krause.net/multiplot", bool fullscreen=false) : Multiplot_base(x,y,w,h, title_str_,fullscreen)
+		{
+			title_str = title_str_;
+			traces.push_back( Trace() ); // create one trace
+			windows().push_back(this);
+			show();
+		}
+
+		
+		/**
+		*	Access function. allows direct access to a trace.
+		*/
+		Trace& operator[](int _trace) { return trace(_trace); }
+		/**
+		*	Access function. allows direct access to a trace.
+		*/
+		Trace& operator()(int _trace) { return trace(_trace); }
+
+		/**
+		*	sets the current trace.  traces are numbered
+		*	from zero to N. memory for the traces is automatically allocated. 
+		*/
+		Trace& trace(unsigned int _trace)
+		{
+			cur_trace = _trace;
+			add_traces(cur_trace);
+			return traces[_trace];
+		}
+		
+		/**
+		*	returns the view number n. views are numbered from zero to N and
+		*	drawn on top of the traces. they refer to samples in your own memory:
+		*	m.view(0).data(samples, count); see class Trace_view.
+		*/
+		Trace_view& view(unsigned int n)
+		{
+			if (views.size() <= n) { views.resize(n + 1); }
+			return views[n];
+		}
+
+		/**
+		* plots a point at x,y to the currently active trace.
+		* select a trace with a call to trace(int _tracenumber);
+		*/
+		void plot(const double x, const double y)
+		{
+			// with a render thread, don't wait for the frame that is being drawn
+			if (render_running) { push(cur_trace, x, y); return; }
+			traces[cur_trace].plot(x,y);
+		}
+		
+		/**
+		* plots a vector of values to the currently active trace.
+		* the x value is running from 0 .. vector.size()-1
+		* select a trace with a call to trace(int _tracenumber);
+		*/
+		template<class T> void plot(const std::vector<T>& v)
+		{
+			plot_range(v.begin(), v.end());
+		}
+
+		/**
+		* plots the values of vector vx and vy to the currently active trace.
+		* vx and vy must have the same length. 
+		* select a trace with a call to trace(int _tracenumber);
+		*/
+		template<class T> void plot(const std::vector<T>& vx, const std::vector<T>& vy)
+		{
+			if (vx.size() != vy.size()) { throw std::length_error("Multiplot: both vectors must have the same length.\n"); }
+			auto lock = frame_lock();
+			traces[cur_trace].plot_range(vx.begin(), vx.end(), vy.begin());
+		}
+
+		/**
+		* plots the values of a std::array to the currently active trace.
+		* the x value is running from 0 .. N-1
+		*/
+		template<class T, size_t N> void plot(const std::array<T, N>& v)
+		{
+			auto lock = frame_lock();
+			traces[cur_trace].plot(v.data(), N);
+		}
+
+		/**
+		* plots count values of the array y to the currently active trace, taking every
+		* stride-th element (e.g. one channel of interleaved data). the x value is running
+		* from 0 .. count-1. this is much faster than calling plot(x,y) count times.
+		*/
+		template<class T> void plot(const T* y, size_t count, size_t stride = 1)
+		{
+			auto lock = frame_lock();
+			traces[cur_trace].plot(y, count, stride);
+		}
+
+		/**
+		* plots count points of the arrays x and y to the currently active trace, taking
+		* every stride_x-th element of x and every stride_y-th element of y.
+		*/
+		template<class T> void plot(const T* x, const T* y, size_t count, size_t stride_x = 1, size_t stride_y = 1)
+		{
+			auto lock = frame_lock();
+			traces[cur_trace].plot(x, y, count, stride_x, stride_y);
+		}
+
+		/**
+		* plots the values of the random access range [first, last) to the currently
+		* active trace. the x value is running from 0 .. last-first-1
+		*/
+		template<class It> void plot_range(It first, It last)
+		{
+			auto lock = frame_lock();
+			traces[cur_trace].plot_range(first, last);
+		}
+
+		/**
+		*	sets up the queue for push(): capacity is the maximum number of samples that can
+		*	wait for the next frame, policy says what happens if a producer finds the queue full
+		*	(MP_DROP_OLDEST, MP_DROP_NEWEST or MP_BLOCK). call this before starting the producer
+		*	threads. without a call, push() creates a queue for 65536 samples with MP_DROP_OLDEST.
+		*/
+		void ingest_queue(size_t capacity, MP_BACKPRESSURE policy = MP_DROP_OLDEST)
+		{
+			drain();
+			delete queue.exchange(new Sample_queue<Sample>(capacity, policy));
+		}
+
+		/**
+		*	thread-safe version of plot(): appends the point (x,y) to trace number _trace.
+		*	can be called from any thread, e.g. from several data acquisition threads at once.
+		*	the samples are queued without locking and moved into the traces when the window
+		*	is drawn next (or when you call drain()), using the color, line width and point size
+		*	that are set for the trace at that time.
+		*/
+		void push(unsigned int _trace, double x, double y)
+		{
+			Sample_queue<Sample>* q = queue.load(std::memory_order_acquire);
+			if (!q)
+			{
+				// first push: create the default queue. if another thread was faster, use its queue.
+				Sample_queue<Sample>* fresh = new Sample_queue<Sample>(65536, MP_DROP_OLDEST);
+				if (queue.compare_exchange_strong(q, fresh)) { q = fresh; } else { delete fresh; }
+			}
+			q->push(Sample{ _trace, x, y });
+		}
+
+		/**
+		*	moves all samples that were queued by push() into their traces.
+		*	must be called from the thread that draws (it is called automatically before drawing).
+		*	returns the number of samples moved.
+		*/
+		size_t drain()
+		{
+			Sample_queue<Sample>* q = queue.load(std::memory_order_acquire);
+			if (!q) { return 0; }
+			// don't take more than what is queued now, so busy producers can't stall the drawing
+			size_t n = q->size(), count = 0;
+			Sample s;
+			while (count < n && q->try_pop(s))
+			{
+				add_traces(s.trace);
+				traces[s.trace].plot(s.x, s.y);
+				count++;
+			}
+			return count;
+		}
+
+		/**
+		*	number of samples given to push() that were discarded because the queue was full.
+		*/
+		unsigned long long dropped_samples() const
+		{
+			Sample_queue<Sample>* q = queue.load(std::memory_order_acquire);
+			return q ? q->dropped_oldest.load() + q->dropped_newest.load() : 0;
+		}
+
+		/**
+		* change current drawing color for current trace.
+		*/
+		void color3f(float r, float g, float b) { traces[cur_trace].color3f(r,g,b); }
+		
+		/**
+		* sets the window title given a wide string.
+		*/
+		void title(const std::wstring& title_) { title_str = title_; dirty |= DIRTY_STYLE; }
+
+		/**
+		* sets the window title given a string or char*.
+		*/
+		void title(const std::string&  title_) { title_str = std::wstring(title_.begin(), title_.end()); dirty |= DIRTY_STYLE; }
+		
+		/**
+		* changes current line width.
+		*/
+		void linewidth(float width){ traces[cur_trace].linewidth(width); }
+		/**
+		* changes current point size.
+		*/
+		void pointsize(float psize){ traces[cur_trace].pointsize(psize); }
+		/**
+		* changes scrolling behaviour for current trace - see class Trace for details.
+		*/
+		void scrolling(MP_SCROLLING scrolling_type, int max_points_to_plot=-1){ traces[cur_trace].scrolling(scrolling_type, max_points_to_plot); }
+		
+		// short hand for backwards compatibility with older Multiplot versions
+		void scrolling(int max_points_to_plot) { traces[cur_trace].scrolling(MP_SCROLL_LEFT, max_points_to_plot); } 
+		/**
+		* compresses the older points of the current trace - see Trace::compression().
+		*/
+		void compression(size_t block_points = 4096, double quantum = 0.0) { traces[cur_trace].compression(block_points, quantum); }
+		/**
+		* draws the current trace as a density map - see Trace::density().
+		*/
+		void density(bool on = true, bool log_scale = true) { traces[cur_trace].density(on, log_scale); }
+
+		/**
+		* changes the (auto-)scaling behaviour of the multiplot window. you can choose between 
+		* MP_AUTO_SCALE
+		* MP_AUTO_SCALE_EQUAL
+		* MP_FIXED_SCALE
+		*/
+		void scaling(enum MP_SCALING sc, double x_min=-10, double x_max= 10, double y_min=-10, double y_max=10)
+		{
+			scaling_ = sc;
+			dirty |= DIRTY_SCALING;
+			range_min.x = x_min;
+			range_min.y = y_min;
+			range_max.x = x_max;
+			range_max.y = y_max;
+			nav.saved = false;
+		}
+
+		/**
+		*	mouse navigation (on by default): the mouse wheel zooms around the
+		*	mouse pointer, dragging with the left button moves the view, dragging with the right
+		*	button (or shift + left button) zooms into the dragged box and a double click returns
+		*	to the scaling before the first zoom. zooming switches to MP_FIXED_SCALE.
+		*	frames that take longer than preview_ms to draw are kept in a texture: while the mouse
+		*	moves, this frame is drawn stretched to the new view, and the full frame follows
+		*	when the mouse rests or the button is released.
+		*/
+		void navigation(bool on = true, double preview_ms = 10.0)
+		{
+			nav.on = on;
+			nav.preview_ms = preview_ms;
+			if (!on) { nav.drag = DRAG_NONE; nav.active = false; }
+		}
+
+		/**
+		*	zooms in by factor (< 1 zooms out) around the window pixel (x, y), y from the top.
+		*	like all of the following, it switches to MP_FIXED_SCALE and shows up with the next redraw()
+		*/
+		void zoom(double factor, int x, int y)
+		{
+			Vec2d lo, hi;
+			if (!(factor > 0.0) || !visible_range(lo, hi)) { return; }
+			const Vec2d c = axis_point(x, y, lo, hi);
+			show_range(Vec2d(c.x + (lo.x - c.x) / factor, c.y + (lo.y - c.y) / factor), Vec2d(c.x + (hi.x - c.x) / factor, c.y + (hi.y - c.y) / factor));
+		}
+
+		/** moves the plot by (dx, dy) pixels, dy > 0 moves it down */
+		void pan(int dx, int dy)
+		{
+			Vec2d lo, hi;
+			if (!visible_range(lo, hi)) { return; }
+			const double ax = dx * (hi.x - lo.x) / width, ay = dy * (hi.y - lo.y) / height;
+			show_range(Vec2d(lo.x - ax, lo.y + ay), Vec2d(hi.x - ax, hi.y + ay));
+		}
+
+		/** zooms into the box between the window pixels (x0, y0) and (x1, y1) */
+		void zoom_box(int x0, int y0, int x1, int y1)
+		{
+			Vec2d lo, hi;
+			if (x0 == x1 || y0 == y1 || !visible_range(lo, hi)) { return; }
+			const Vec2d a = axis_point(std::min(x0, x1), std::max(y0, y1), lo, hi);
+			const Vec2d b = axis_point(std::max(x0, x1), std::min(y0, y1), lo, hi);
+			show_range(a, b);
+		}
+
+		/** returns to the scaling before the first zoom(), pan() or zoom_box() */
+		void unzoom()
+		{
+			if (!nav.saved) { return; }
+			scaling_ = nav.scaling;
+			range_min = nav.range_min;
+			range_max = nav.range_max;
+			nav.saved = false;
+			dirty |= DIRTY_SCALING;
+		}
+
+
+
+		/**
+		*	starts a render thread that owns the opengl context and the event handling of
+		*	the window and draws at most max_fps frames per second. afterwards, redraw() only
+		*	requests a new frame and returns immediately, check() returns whether the window is
+		*	still open, and plot(x,y) goes through the lock-free queue of push(), so the calling
+		*	loop never waits for the drawing. all other calls that change the plot (colors, traces,
+		*	scaling, clear ...) must hold the frame lock: { auto lock = m.frame_lock(); m.color3f(1,0,0); }
+		*	max_fps <= 0 stops the render thread again.
+		*	with FLTK, the render thread handles the events of all FLTK windows, so use it with one window.
+		*	under win32, window messages are still handled by check() in the thread that created the window.
+		*/
+		void render_thread(float max_fps = 60.0f)
+		{
+			if (render_running)
+			{
+				render_running = false;
+				renderer.join();
+				#ifndef MULTIPLOT_FLTK
+				make_current();
+				#endif
+			}
+			if (max_fps <= 0) { return; }
+
+			if (!queue.load()) { ingest_queue(65536, MP_BLOCK); } // don't lose samples by default
+			frame_period = std::chrono::duration<double>(1.0 / max_fps);
+			window_open = true;
+			frame_requested = true;
+			#ifdef MULTIPLOT_FLTK
+			Fl::lock(); // enables the multithreading support of fltk
+			Fl::unlock();
+			#endif
+			#ifndef MULTIPLOT_FLTK
+			release_current(); // the context can only be current in one thread
+			#endif
+			render_running = true;
+			renderer = std::thread(&Multiplot::render_loop, this);
+		}
+
+		/**
+		*	returns a lock that keeps the render thread from drawing while you change the plot.
+		*	without a render thread, the returned lock does nothing.
+		*/
+		std::unique_lock<std::mutex> frame_lock()
+		{
+			if (!render_running) { return std::unique_lock<std::mutex>(); }
+			return std::unique_lock<std::mutex>(frame_mutex);
+		}
 
+		/**
+		*	redraws the window. with a render thread, this just requests a new frame.
+		*	nothing is drawn if nothing has changed since the last frame (no new points,
+		*	no new colors, grid or scaling settings, same window size). calls that come
+		*	faster than the frame rate limit (see frame_rate_limit()) are combined into one
+		*	frame, which is drawn by a later call of redraw() or check().
+		*/
+		void redraw()
+		{
+			if (recorder) { recorder->op(Session_recorder::OP_REDRAW); }
+			if (render_running) { frame_requested = true; return; }
+			if (!needs_redraw()) { skipped_frames_++; return; }
 
-			/**
-			*	if you call scrolling with a positive number of points to be plotted,
-			*	your graph will scroll left out of the plot-window as you add new plot-points beyond number_of_points_to_plot_.
-			*	Zero or a negative number disables scrolling.
-			*/
-			void scrolling(MP_SCROLLING scrolling_type_, int number_of_points_to_plot_ = -1)
+			const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			if (now - last_frame < min_frame_interval)
 			{
-				if (MP_NO_SCROLL != scrolling_type_ && number_of_points_to_plot_ <= 0) { throw("error calling Multiplot::scrolling(): The number of points to plot must be a positive integer greater zero."); }
-				scroll = scrolling_type_;
-				max_points_to_plot = number_of_points_to_plot_;
-
-				if(max_points_to_plot <= 0)
-				{
-					scroll=MP_NO_SCROLL;
-					return;
-				}
+				if (redraw_pending) { skipped_frames_++; }
+				redraw_pending = true;
+				return;
 			}
+			redraw_pending = false;
+			last_frame = now;
+			timed_present([this] { Multiplot_base::redraw(); });
+		}
 
-			/**
-			*	clear() removes all points from the trace.
-			*	the trace is empty afterwards and can be filled
-			*	with plot(x,y) again.
-			*/
-			void clear() { std::vector<Point2d>::clear(); pos=0; }
-		};
-
+		/**
+		*	propagates window events. returns false if the window was closed (ESC).
+		*	also draws a frame that was held back by redraw() because of the frame rate limit.
+		*/
+		bool check()
+		{
+			if (render_running)
+			{
+				#ifdef MULTIPLOT_WIN32
+				std::lock_guard<std::mutex> lock(frame_mutex);
+				window_open = Multiplot_base::check() && window_open;
+				#endif
+				return window_open;
+			}
+			if (redraw_pending && std::chrono::steady_clock::now() - last_frame >= min_frame_interval)
+			{
+				redraw();
+			}
+			if (views_loaded() && !redraw_pending) { redraw(); }
+			return check_events();
+		}
 
-		virtual ~Multiplot() { hide(); check(); }
-        
-		Multiplot(const int x,const int y,const int w,const int h, const std::wstring& title_str_=L"www.andre-krause.net/multiplot", bool fullscreen=false) : Multiplot_base(x,y,w,h, title_str_,fullscreen)
+		/**
+		*	redraw() draws at most fps frames per second, more calls are combined.
+		*	the default is 60, zero or less disables the limit.
+		*/
+		void frame_rate_limit(float fps)
 		{
-			title_str = title_str_;
-			traces.push_back( Trace() ); // create one trace
-			show();
+			min_frame_interval = std::chrono::duration<double>(fps > 0 ? 1.0 / fps : 0.0);
 		}
 
-		
 		/**
-		*	Access function. allows direct access to a trace.
+		*	number of redraw() calls that did not draw, because nothing had changed
+		*	or because they were combined with another call.
 		*/
-		Trace& operator[](int _trace) { return trace(_trace); }
+		unsigned long long skipped_frames() const { return skipped_frames_; }
+
 		/**
-		*	Access function. allows direct access to a trace.
+		*	forces the next redraw() to draw, even if multiplot thinks nothing has changed.
+		*	e.g. after changing points of a trace directly (see Trace::modified()).
 		*/
-		Trace& operator()(int _trace) { return trace(_trace); }
+		void invalidate() { dirty = DIRTY_ALL; }
 
 		/**
-		*	sets the current trace.  traces are numbered
-		*	from zero to N. memory for the traces is automatically allocated. 
+		*	collects what goes into each frame (see Frame_metrics): the time of each phase of
+		*	draw() and of every trace, the buffer swap and the event handling, the numbers of
+		*	vertices, draw calls and points. the last frames are kept, frames = 0 switches it off.
+		*	costs a few clock readings per frame.
 		*/
-		Trace& trace(unsigned int _trace)
+		void collect_metrics(size_t frames = 300)
 		{
-			cur_trace = _trace;
-
-			if(traces.size() <= cur_trace )
+			auto lock = frame_lock();
+			if (frames && !metrics_frames)
 			{
-				for(size_t a = 0; a < cur_trace - traces.size() + 1; a++)
-					traces.push_back(Trace());
+				metrics_history.clear();
+				metrics_count = 0;
+				metrics_epoch = std::chrono::steady_clock::now();
+				metrics_plotted = plotted();
+				metrics_events_ms = 0;
 			}
-			return traces[_trace];
+			metrics_frames = frames;
+			while (metrics_history.size() > frames) { metrics_history.pop_front(); }
+			if (!frames) { hud_ = false; }
 		}
-		
+
 		/**
-		* plots a point at x,y to the currently active trace.
-		* select a trace with a call to trace(int _tracenumber);
+		*	the metrics of the kept frames, the oldest first. see collect_metrics().
 		*/
-		void plot(const float x, const float y) {  traces[cur_trace].plot(x,y); }
-		
+		std::vector<Frame_metrics> metrics()
+		{
+			auto lock = frame_lock();
+			return std::vector<Frame_metrics>(metrics_history.begin(), metrics_history.end());
+		}
+
 		/**
-		* plots a vector of values to the currently active trace.
-		* the x value is running from 0 .. vector.size()-1
-		* select a trace with a call to trace(int _tracenumber);
+		*	shows the times of the last frames as bars in the lower right corner: events (cyan),
+		*	ingest (green), bounds and grid (gray), traces (yellow), caption (magenta) and swap (red).
+		*	the white line marks 16.7 ms (60 fps). switches collect_metrics() on if needed.
 		*/
-		template<class T> void plot(const std::vector<T>& v)
+		void hud(bool on)
+		{
+			if (on && !metrics_frames) { collect_metrics(); }
+			auto lock = frame_lock();
+			hud_ = on;
+			dirty |= DIRTY_STYLE;
+		}
+
+		/**
+		*	writes the kept frames as chrome trace-event json, see Frame_metrics::write_trace().
+		*/
+		void export_trace(const std::string& filename) { Frame_metrics::write_trace(filename, metrics()); }
+
+		/**
+		*	starts logging all calls that change the traces (plot, color3f, linewidth, pointsize,
+		*	trace, scrolling, clear) and redraw() with time stamps to a binary file, see
+		*	class Session_recorder. a point costs about 10 bytes. replay() plays the file back.
+		*	the points that are already in the traces are not written, only their current
+		*	settings. changes made directly through the std::vector interface are not logged.
+		*/
+		void record(const std::string& filename)
 		{
-			for(size_t x=0;x<v.size();x++)
+			auto lock = frame_lock();
+			recorder.reset(); // finish a previous recording
+			recorder.reset(new Session_recorder(filename));
+			for (Trace& t : traces)
 			{
-				traces[cur_trace].plot(float(x), float(v[x]));
+				t.recorder = recorder.get();
+				t.color3f(t.cur_col[0], t.cur_col[1], t.cur_col[2]);
+				t.linewidth(t.cur_line_width);
+				t.pointsize(t.cur_point_size);
+				if (MP_NO_SCROLL != t.scroll) { t.scrolling(t.scroll, int(t.max_points_to_plot)); }
 			}
 		}
 
 		/**
-		* plots the values of vector vx and vy to the currently active trace.
-		* vx and vy must have the same length. 
-		* select a trace with a call to trace(int _tracenumber);
+		*	stops a recording started with record() and closes the file.
 		*/
-		template<class T> void plot(const std::vector<T>& vx, const std::vector<T>& vy)
+		void stop_recording()
 		{
-			if (vx.size() != vy.size()) { throw std::length_error("Multiplot: both vectors must have the same length.\n"); }
-			for (size_t i = 0; i<vx.size(); i++)
+			auto lock = frame_lock();
+			for (Trace& t : traces) { t.recorder = nullptr; }
+			recorder.reset();
+		}
+
+		/**
+		*	plays a file written by record() into this window. speed 1 replays in real time,
+		*	2 twice as fast and so on. with speed 0, the file is replayed as fast as possible
+		*	(still drawing at most frame_rate_limit() frames per second).
+		*	returns false if the window was closed during the replay.
+		*/
+		bool replay(const std::string& filename, double speed = 1.0)
+		{
+			std::ifstream in(filename, std::ios::binary);
+			char magic[8] = {};
+			in.read(magic, 8);
+			if (!in || std::string(magic, 8) != "MPSESS1\n") { throw std::runtime_error("Multiplot: " + filename + " is not a session recording"); }
+
+			auto varint = [&in]() { uint64_t v = 0; int c, shift = 0; do { c = in.get(); v |= uint64_t(c & 0x7f) << shift; shift += 7; } while (c & 0x80 && in); return v; };
+			auto f = [&in]() { unsigned char b[4] = {}; in.read(reinterpret_cast<char*>(b), 4); uint32_t u = b[0] | b[1] << 8 | b[2] << 16 | uint32_t(b[3]) << 24; float v; memcpy(&v, &u, 4); return v; };
+			auto d = [&in]() { unsigned char b[8] = {}; in.read(reinterpret_cast<char*>(b), 8); uint64_t u = 0; for (int k = 0; k < 8; k++) { u |= uint64_t(b[k]) << (8 * k); } double v; memcpy(&v, &u, 8); return v; };
+
+			using namespace std::chrono;
+			const steady_clock::time_point start = steady_clock::now();
+			uint64_t time = 0; // of the current record, in microseconds
+			trace(0); // the recording starts with trace 0, see Session_recorder
+			std::vector<float> values;
+			int code;
+			while ((code = in.get()) != EOF)
 			{
-				traces[cur_trace].plot(float(vx[i]), float(vy[i]));
+				time += varint();
+				if (speed > 0)
+				{
+					// wait for the time of the record, keeping the window responsive
+					const steady_clock::time_point due = start + duration_cast<steady_clock::duration>(microseconds(time) / speed);
+					while (steady_clock::now() < due)
+					{
+						if (!check()) { return false; }
+						std::this_thread::sleep_until(std::min(due, steady_clock::now() + milliseconds(10)));
+					}
+				}
+				switch (code)
+				{
+				case Session_recorder::OP_TRACE:		trace((unsigned int)varint()); break;
+				case Session_recorder::OP_PLOT:			{ const float x = f(); plot(x, f()); } break;
+				case Session_recorder::OP_PLOT_DOUBLE:	{ const double x = d(); plot(x, d()); } break;
+				case Session_recorder::OP_COLOR:		{ const float r = f(), g = f(); color3f(r, g, f()); } break;
+				case Session_recorder::OP_LINEWIDTH:	linewidth(f()); break;
+				case Session_recorder::OP_POINTSIZE:	pointsize(f()); break;
+				case Session_recorder::OP_CLEAR:		clear(cur_trace); break;
+				case Session_recorder::OP_REDRAW:		redraw(); if (!check()) { return false; } break;
+				case Session_recorder::OP_DENSITY:		{ const uint64_t v = varint(); density((v & 1) != 0, (v & 2) != 0); } break;
+				case Session_recorder::OP_SCROLLING:
+				{
+					const MP_SCROLLING type = MP_SCROLLING(varint());
+					const int max_points = int(varint());
+					scrolling(type, MP_NO_SCROLL == type ? -1 : max_points);
+				} break;
+				case Session_recorder::OP_PLOT_Y:
+				case Session_recorder::OP_PLOT_XY:
+				{
+					const size_t count = size_t(varint());
+					const size_t per_point = Session_recorder::OP_PLOT_XY == code ? 2 : 1;
+					values.resize(count * per_point);
+					for (float& v : values) { v = f(); }
+					if (per_point == 2) { plot(values.data(), values.data() + 1, count, 2, 2); }
+					else { plot(values.data(), count); }
+				} break;
+				default: throw std::runtime_error("Multiplot: " + filename + " is damaged");
+				}
 			}
+			redraw();
+			return check();
 		}
 
 		/**
-		* change current drawing color for current trace.
+		*	draws the plot and writes it to an image file: .png, otherwise binary .ppm.
+		*	works with all backends, stop a render thread first.
 		*/
-		void color3f(float r, float g, float b) { traces[cur_trace].color3f(r,g,b); }
-		
+		void save(const std::string& filename)
+		{
+			if (render_running) { throw std::logic_error("Multiplot::save(): stop the render thread first."); }
+			make_current();
+			draw();
+			glFinish();
+			const size_t width_ = size_t(w()), height_ = size_t(h());
+			std::vector<unsigned char> rgb(width_ * height_ * 3);
+			GLint buffer = GL_BACK;
+			glGetIntegerv(GL_DRAW_BUFFER, &buffer);
+			glReadBuffer(GLenum(buffer));
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glReadPixels(0, 0, GLsizei(width_), GLsizei(height_), GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+			Image_writer::write(filename, rgb.data(), width_, height_, true);
+		}
+
 		/**
-		* sets the window title given a wide string.
+		* sleeps for the given amount of milliseconds
+		* useful to control the speed of animated graphs.
 		*/
-		void title(const std::wstring& title_) { title_str = title_; }
+		void sleep(unsigned int milliseconds_)
+		{
+			using namespace std;
+			this_thread::sleep_for(chrono::milliseconds(milliseconds_));
+		}
 
+		
 		/**
-		* sets the window title given a string or char*.
-		*/
-		void title(const std::string&  title_) { title_str = std::wstring(title_.begin(), title_.end()); }
+		 *	call this function if you wish a grid to be plotted in your graph.
+		 *	by default, no grids are plotted. call this function with the first 
+		 *	two arguments set to either MP_NO_GRID,	MP_LINEAR_GRID or MP_LOG_GRID.
+		 *	MP_LOG_GRID makes the axis logarithmic, with lines at every decade.
+		 *	the next two arguments gridx_step and gridy_step specify the grid spacing.
+		 *	Zero or a negative value like -1 enables auto - spacing.
+		 *	The last parameter w sets the grid-linewidth. the default is 1 pixel.
+		 */
+		void grid(enum MP_GRIDSTYLE ggridx=MP_LINEAR_GRID, enum MP_GRIDSTYLE ggridy=MP_LINEAR_GRID, float ggridx_step=-1.0, float ggridy_step=-1.0, float w=1.0)
+		{
+			gridx=ggridx;
+			gridy=ggridy;
+			dirty |= DIRTY_GRID;
+			gridx_step=ggridx_step;
+			gridy_step=ggridy_step;
+			grid_linewidth=w;
+		}
 		
 		/**
-		* changes current line width.
+		*	sets the background color
 		*/
-		void linewidth(float width){ traces[cur_trace].linewidth(width); }
+		void bg_color(float r, float g, float b)
+		{
+			bg_col.r=r;
+			bg_col.g=g;
+			bg_col.b=b;
+			dirty |= DIRTY_STYLE;
+			glClearColor(bg_col.r, bg_col.g, bg_col.b, 1);		// Set The background color
+		}
+
+
 		/**
-		* changes current point size.
+		*	sets the grid color
 		*/
-		void pointsize(float psize){ traces[cur_trace].pointsize(psize); }
+		void grid_color(float r, float g, float b)
+		{
+			grid_col.r=r;
+			grid_col.g=g;
+			grid_col.b=b;
+			dirty |= DIRTY_STYLE;
+		}
+
+
 		/**
-		* changes scrolling behaviour for current trace - see class Trace for details.
+		*	returns the bounding box of all traces, without drawing them.
+		*	returns false if all traces are empty.
 		*/
-		void scrolling(MP_SCROLLING scrolling_type, int max_points_to_plot=-1){ traces[cur_trace].scrolling(scrolling_type, max_points_to_plot); }
-		
-		// short hand for backwards compatibility with older Multiplot versions
-		void scrolling(int max_points_to_plot) { traces[cur_trace].scrolling(MP_SCROLL_LEFT, max_points_to_plot); } 
+		bool bounds(double& x_min, double& y_min, double& x_max, double& y_max)
+		{
+			Vec2d lo(std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+			Vec2d hi(-std::numeric_limits<double>::max(), -std::numeric_limits<double>::max());
+			for (Trace& t : traces) { t.extend_bounds(lo, hi); }
+			for (Trace_view& v : views) { v.extend_bounds(lo, hi); }
+			x_min = lo.x; y_min = lo.y;
+			x_max = hi.x; y_max = hi.y;
+			return lo.x <= hi.x;
+		}
+
+		bool bounds(float& x_min, float& y_min, float& x_max, float& y_max)
+		{
+			double b[4];
+			const bool found = bounds(b[0], b[1], b[2], b[3]);
+			x_min = float(b[0]); y_min = float(b[1]);
+			x_max = float(b[2]); y_max = float(b[3]);
+			return found;
+		}
+
 
 		/**
-		* changes the (auto-)scaling behaviour of the multiplot window. you can choose between 
-		* MP_AUTO_SCALE
-		* MP_AUTO_SCALE_EQUAL
-		* MP_FIXED_SCALE
+		 *	this function call simply clears all traces
+		 */
+		void clear_all()
+		{
+			for (unsigned int a = 0; a < traces.size(); a++)
+			{
+				traces[a].clear();
+				traces[a].pos = 0;
+			}
+			cur_trace = 0;
+		}
+
+		
+		/**
+		*	this function call clears trace number t
 		*/
-		void scaling(enum MP_SCALING sc, float x_min=-10, float x_max= 10, float y_min=-10, float y_max=10)
+		void clear(int trace)
 		{
-			scaling_ = sc;
-			range_min.x = x_min;
-			range_min.y = y_min;
-			range_max.x = x_max;
-			range_max.y = y_max;
+			traces[trace].clear();
+			traces[trace].pos=0;
+		}
+
+	protected:
+		float cur_point_size = 0.0f;
+		unsigned int cur_trace = 0;
+
+		std::wstring title_str;		// stores the user-title, so we can add ranges
+		std::wstring caption_str;
+		Color3f bg_col  { 0.0f, 0.0f, 0.0f };
+		Color3f grid_col{ 0.8f, 0.8f, 0.8f };
+		
+
+
+		// scaling behaviour
+		MP_SCALING scaling_ = MP_AUTO_SCALE;
+		Vec2d range_min, range_max;
+		Vec2d minimum{ -std::numeric_limits<double>::max() , -std::numeric_limits<double>::max() };
+		Vec2d maximum{  std::numeric_limits<double>::max() ,  std::numeric_limits<double>::max() };
+		Point2d scale;
+		Vec2d offset;	// in double precision, so large values like unix timestamps can be shown
+
+		// mouse navigation, see navigation()
+		enum { DRAG_NONE, DRAG_PAN, DRAG_BOX };
+		struct Navigation
+		{
+			bool on = true;
+			double preview_ms = 10.0;
+			bool active = false;				// the mouse zooms or moves the view, slow frames are previewed
+			int drag = DRAG_NONE;
+			int x0 = 0, y0 = 0, x = 0, y = 0;	// window pixels where the drag started and where the mouse is
+			bool saved = false;					// the scaling before the first zoom, for unzoom()
+			MP_SCALING scaling = MP_AUTO_SCALE;
+			Vec2d range_min, range_max;
+			Vec2d frame_lo, frame_hi;			// the visible range of the frame in frame_cache
+		} nav;
+		Frame_cache frame_cache;
+
+		// the visible range in axis coordinates: the fixed range, or the range of the last frame
+		bool visible_range(Vec2d& lo, Vec2d& hi) const
+		{
+			if (0 == width || 0 == height) { return false; }
+			if (MP_FIXED_SCALE == scaling_)
+			{
+				const Axis_transform axes = axis_transform();
+				lo = range_min;
+				hi = range_max;
+				if (axes.log_x) { log_range(lo.x, hi.x); }
+				if (axes.log_y) { log_range(lo.y, hi.y); }
+			}
+			else
+			{
+				lo = offset;
+				hi = Vec2d(offset.x + width / scale.x, offset.y + height / scale.y);
+			}
+			return std::isfinite(hi.x - lo.x) && std::isfinite(hi.y - lo.y);
+		}
+
+		// the window pixel (x, y), y from the top, in axis coordinates if the window shows [lo, hi]
+		Vec2d axis_point(int x, int y, const Vec2d& lo, const Vec2d& hi) const
+		{
+			return Vec2d(lo.x + (hi.x - lo.x) * x / width, hi.y - (hi.y - lo.y) * y / height);
+		}
+
+		// shows the range [lo, hi] in axis coordinates with MP_FIXED_SCALE. ranges too small
+		// for the precision of doubles or too large for their range are ignored
+		void show_range(Vec2d lo, Vec2d hi)
+		{
+			const Axis_transform axes = axis_transform();
+			if (axes.log_x) { lo.x = std::pow(10.0, lo.x); hi.x = std::pow(10.0, hi.x); }
+			if (axes.log_y) { lo.y = std::pow(10.0, lo.y); hi.y = std::pow(10.0, hi.y); }
+			const double eps = 1e-12;
+			if (!(hi.x - lo.x > eps * std::max(std::abs(lo.x), std::abs(hi.x))) || !std::isfinite(hi.x - lo.x)) { return; }
+			if (!(hi.y - lo.y > eps * std::max(std::abs(lo.y), std::abs(hi.y))) || !std::isfinite(hi.y - lo.y)) { return; }
+			if (!nav.saved)
+			{
+				nav.saved = true;
+				nav.scaling = scaling_;
+				nav.range_min = range_min;
+				nav.range_max = range_max;
+			}
+			scaling_ = MP_FIXED_SCALE;
+			range_min = lo;
+			range_max = hi;
+			dirty |= DIRTY_SCALING;
+		}
+
+		// asks for a frame after a mouse event
+		void request_frame()
+		{
+			#ifdef MULTIPLOT_FLTK
+			Fl_Gl_Window::redraw();
+			#else
+			if (render_running) { frame_requested = true; } else { redraw_pending = true; }
+			#endif
+		}
+
+		// mouse input from the window in window pixels, y from the top.
+		// button 1 is the left and 3 the right button
+		virtual void mouse_press(int button, int x, int y, bool shift)
+		{
+			if (!nav.on) { return; }
+			nav.drag = (3 == button || (1 == button && shift)) ? DRAG_BOX : 1 == button ? DRAG_PAN : DRAG_NONE;
+			if (DRAG_NONE == nav.drag) { return; }
+			nav.x0 = nav.x = x;
+			nav.y0 = nav.y = y;
+			nav.active = true;
+		}
+
+		virtual void mouse_drag(int x, int y)
+		{
+			if (DRAG_NONE == nav.drag) { return; }
+			if (DRAG_PAN == nav.drag) { pan(x - nav.x, y - nav.y); }
+			nav.x = x;
+			nav.y = y;
+			dirty |= DIRTY_SCALING; // the box moved
+			request_frame();
+		}
+
+		virtual void mouse_release(int x, int y)
+		{
+			if (DRAG_PAN == nav.drag) { pan(x - nav.x, y - nav.y); }
+			if (DRAG_BOX == nav.drag && std::abs(x - nav.x0) > 3 && std::abs(y - nav.y0) > 3) { zoom_box(nav.x0, nav.y0, x, y); }
+			nav.drag = DRAG_NONE;
+			mouse_rest();
+		}
+
+		virtual void mouse_wheel(double steps, int x, int y)
+		{
+			if (!nav.on || 0.0 == steps) { return; }
+			zoom(std::pow(1.25, -steps), x, y); // steps > 0 is towards the user
+			nav.active = true;
+			request_frame();
+		}
+
+		virtual void mouse_double_click()
+		{
+			if (!nav.on) { return; }
+			unzoom();
+			nav.drag = DRAG_NONE;
+			nav.active = false;
+			dirty |= DIRTY_SCALING;
+			request_frame();
+		}
+
+		// no more wheel events for a while: draws the full frame
+		virtual void mouse_rest()
+		{
+			if (!nav.active || DRAG_NONE != nav.drag) { return; }
+			nav.active = false;
+			dirty |= DIRTY_SCALING;
+			request_frame();
+		}
+
+		#ifdef MULTIPLOT_FLTK
+		static void rest_timeout(void* m) { static_cast<Multiplot*>(m)->mouse_rest(); }
+
+		int handle(int event) override
+		{
+			if (!nav.on) { return Fl_Gl_Window::handle(event); }
+			const int x = Fl::event_x(), y = Fl::event_y();
+			switch (event)
+			{
+			case FL_PUSH:
+				if (Fl::event_clicks() && FL_LEFT_MOUSE == Fl::event_button()) { mouse_double_click(); }
+				else { mouse_press(Fl::event_button(), x, y, 0 != Fl::event_state(FL_SHIFT)); }
+				return 1;
+			case FL_DRAG:
+				mouse_drag(x, y);
+				return 1;
+			case FL_RELEASE:
+				mouse_release(x, y);
+				return 1;
+			case FL_MOUSEWHEEL:
+				if (0 == Fl::event_dy()) { break; }
+				mouse_wheel(Fl::event_dy(), x, y);
+				Fl::remove_timeout(rest_timeout, this);
+				Fl::add_timeout(0.15, rest_timeout, this); // the mouse rests if no wheel event comes for 150 ms
+				return 1;
+			}
+			return Fl_Gl_Window::handle(event);
+		}
+		#endif
+
+		// the box of a box zoom
+		void draw_box()
+		{
+			const float x0 = float(nav.x0), x1 = float(nav.x);
+			const float y0 = float(height) - float(nav.y0), y1 = float(height) - float(nav.y);
+			glLineWidth(1.0f);
+			glColor3f(grid_col.r, grid_col.g, grid_col.b);
+			glBegin(GL_LINES);
+			glVertex2f(x0, y0); glVertex2f(x1, y0);
+			glVertex2f(x1, y0); glVertex2f(x1, y1);
+			glVertex2f(x1, y1); glVertex2f(x0, y1);
+			glVertex2f(x0, y1); glVertex2f(x0, y0);
+			glEnd();
+			count_state(2);
+			count_draw(8);
+		}
+
+
+		std::vector< Trace > traces;
+		std::unique_ptr<Session_recorder> recorder;
+
+		// appends traces until trace n exists
+		void add_traces(size_t n)
+		{
+			while (traces.size() <= n)
+			{
+				traces.push_back(Trace());
+				traces.back().recorder = recorder.get();
+				traces.back().index = (unsigned int)(traces.size() - 1);
+			}
 		}
+		std::vector< Trace_view > views;
 
+		// samples pushed by other threads, waiting to be drawn
+		struct Sample { unsigned int trace; double x, y; };
+		std::atomic< Sample_queue<Sample>* > queue{ nullptr };
 
-
-		/**
-		* sleeps for the given amount of milliseconds
-		* useful to control the speed of animated graphs.
-		*/
-		void sleep(unsigned int milliseconds_)
+		// what has to be redrawn. see redraw()
+		enum
 		{
-			using namespace std;
-			this_thread::sleep_for(chrono::milliseconds(milliseconds_));
+			DIRTY_DATA		= 1,	// points have been plotted or cleared
+			DIRTY_STYLE		= 2,	// colors or title changed
+			DIRTY_SCALING	= 4,
+			DIRTY_GRID		= 8,
+			DIRTY_ALL		= 15
+		};
+		unsigned int dirty = DIRTY_ALL;
+		bool redraw_pending = false;
+
+		// frame metrics, see collect_metrics(). the draw code counts its opengl calls with count_draw() and count_state()
+		struct Draw_counters { size_t vertices = 0, draw_calls = 0, state_changes = 0; };
+		static Draw_counters& counters() { static thread_local Draw_counters c; return c; }
+		static void count_draw(size_t vertices) { counters().draw_calls++; counters().vertices += vertices; }
+		static void count_state(size_t changes = 1) { counters().state_changes += changes; }
+		std::deque<Frame_metrics> metrics_history;
+		size_t metrics_frames = 0;						// number of frames kept, 0 = off
+		unsigned long long metrics_count = 0;			// frames drawn since collect_metrics()
+		std::chrono::steady_clock::time_point metrics_epoch;
+		size_t metrics_plotted = 0;						// plotted() at the last frame
+		double metrics_events_ms = 0;					// event handling since the last frame
+		bool hud_ = false;
+
+		size_t plotted() const
+		{
+			size_t n = 0;
+			for (const Trace& t : traces) { n += t.plotted; }
+			return n;
 		}
 
-		
-		/**
-		 *	call this function if you wish a grid to be plotted in your graph.
-		 *	by default, no grids are plotted. call this function with the first 
-		 *	two arguments set to either MP_NO_GRID,	MP_LINEAR_GRID or MP_LOG_GRID.
-		 *	the next two arguments gridx_step and gridy_step specify the grid spacing.
-		 *	Zero or a negative value like -1 enables auto - spacing.
-		 *	The last parameter w sets the grid-linewidth. the default is 1 pixel.
-		 */
-		void grid(enum MP_GRIDSTYLE ggridx=MP_LINEAR_GRID, enum MP_GRIDSTYLE ggridy=MP_LINEAR_GRID, float ggridx_step=-1.0, float ggridy_step=-1.0, float w=1.0)
+		static double ms_since(std::chrono::steady_clock::time_point t)
 		{
-			gridx=ggridx;
-			gridy=ggridy;
-			gridx_step=ggridx_step;
-			gridy_step=ggridy_step;
-			grid_linewidth=w;
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
 		}
-		
-		/**
-		*	sets the background color
-		*/
-		void bg_color(float r, float g, float b)
+
+		// Multiplot_base::check(). the time it spends on events (not drawing) goes into the metrics
+		bool check_events()
 		{
-			bg_col.r=r;
-			bg_col.g=g;
-			bg_col.b=b;
-			glClearColor(bg_col.r, bg_col.g, bg_col.b, 1);		// Set The background color
+			if (!metrics_frames) { return Multiplot_base::check(); }
+			const std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+			const unsigned long long frames = metrics_count;
+			const bool result = Multiplot_base::check();
+			metrics_events_ms += ms_since(t) - drawn_since(frames);
+			return result;
 		}
 
-
-		/**
-		*	sets the grid color
-		*/
-		void grid_color(float r, float g, float b)
+		// swap_buffers(), timed for the metrics
+		template<class F> void timed_present(F present)
 		{
-			grid_col.r=r;
-			grid_col.g=g;
-			grid_col.b=b;
+			if (!metrics_frames) { present(); return; }
+			const std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+			const unsigned long long frames = metrics_count;
+			present();
+			const double ms = ms_since(t) - drawn_since(frames);
+			if (metrics_count != frames && !metrics_history.empty()) { metrics_history.back().swap_ms = ms; }
 		}
 
+		// the time draw() took for the frames after number frames
+		double drawn_since(unsigned long long frames) const
+		{
+			double ms = 0;
+			for (auto m = metrics_history.rbegin(); m != metrics_history.rend() && m->frame >= frames; ++m) { ms += m->total_ms; }
+			return ms;
+		}
 
-		/**
-		 *	this function call simply clears all traces
-		 */
-		void clear_all()
+		// the bars of the hud, see hud()
+		void draw_hud()
 		{
-			for (unsigned int a = 0; a < traces.size(); a++)
+			const size_t bars = std::min<size_t>(metrics_history.size(), 100);
+			const float ms_to_px = 3.0f; // 16.7 ms = 50 pixels
+			const float right = float(width) - 4.0f, bottom = 4.0f;
+			glLineWidth(2.0f);
+			glBegin(GL_LINES);
+			glColor3f(0.15f, 0.15f, 0.15f); // backdrop up to 33 ms
+			for (size_t i = 0; i < 100; i++)
 			{
-				traces[a].clear();
-				traces[a].pos = 0;
+				glVertex2f(right - 2.0f * float(100 - i) + 1.0f, bottom);
+				glVertex2f(right - 2.0f * float(100 - i) + 1.0f, bottom + ms_to_px * 33.3f);
+			}
+			for (size_t i = 0; i < bars; i++)
+			{
+				const Frame_metrics& f = metrics_history[metrics_history.size() - bars + i];
+				const float x = right - 2.0f * float(bars - i) + 1.0f;
+				const double phases[6] = { f.events_ms, f.ingest_ms, f.bounds_ms + f.grid_ms, f.traces_ms(), f.caption_ms, f.swap_ms };
+				const float colors[6][3] = { { 0, 1, 1 }, { 0, 1, 0 }, { 0.6f, 0.6f, 0.6f }, { 1, 1, 0 }, { 1, 0, 1 }, { 1, 0, 0 } };
+				float y = bottom;
+				for (int k = 0; k < 6; k++)
+				{
+					const float top = y + ms_to_px * float(phases[k]);
+					glColor3f(colors[k][0], colors[k][1], colors[k][2]);
+					glVertex2f(x, y);
+					glVertex2f(x, top);
+					y = top;
+				}
+			}
+			glColor3f(1, 1, 1);
+			glVertex2f(right - 200.0f, bottom + ms_to_px * 16.7f);
+			glVertex2f(right, bottom + ms_to_px * 16.7f);
+			glEnd();
+			if (!metrics_history.empty())
+			{
+				const Frame_metrics& f = metrics_history.back();
+				char buf[96];
+				snprintf(buf, sizeof(buf), "%.3g ms  %zu vertices  %zu calls", f.total_ms + f.swap_ms, f.vertices, f.draw_calls);
+				text.add(right - Text_batch::width(buf), bottom + ms_to_px * 16.7f + 4.0f, buf, 1, 1, 1);
 			}
-			cur_trace = 0;
 		}
 
-		
-		/**
-		*	this function call clears trace number t
-		*/
-		void clear(int trace)
+		unsigned long long skipped_frames_ = 0;
+		std::chrono::steady_clock::time_point last_frame;
+		std::chrono::duration<double> min_frame_interval{ 1.0 / 60.0 };
+		double frame_ms = 0.0;		// how long the last draw() took
+
+		// all windows of the process, see Window_manager
+		static std::vector<Multiplot*>& windows() { static std::vector<Multiplot*> w; return w; }
+
+		// draws a frame without handling events, see Window_manager::check().
+		// with FLTK, the frame is drawn by the next Fl::check()
+		void draw_frame()
 		{
-			traces[trace].clear();
-			traces[trace].pos=0;
+			redraw_pending = false;
+			last_frame = std::chrono::steady_clock::now();
+			#ifdef MULTIPLOT_FLTK
+			Fl_Gl_Window::redraw();
+			#else
+			timed_present([this] { make_current(); draw(); swap_buffers(); });
+			#endif
 		}
 
-	protected:
-		float cur_point_size = 0.0f;
-		unsigned int cur_trace = 0;
-
-		std::wstring title_str;		// stores the user-title, so we can add ranges
-		std::wstring caption_str;
-		Color3f bg_col  { 0.0f, 0.0f, 0.0f };
-		Color3f grid_col{ 0.8f, 0.8f, 0.8f };
-		
+		// true if the next frame would look different from the last one.
+		// valid() is false if the window has been resized.
+		bool needs_redraw()
+		{
+			if (dirty || !valid()) { return true; }
+			for (const Trace& t : traces) { if (t.changed) { return true; } }
+			for (const Trace_view& v : views) { if (v.changed || v.loaded()) { return true; } }
+			Sample_queue<Sample>* q = queue.load(std::memory_order_acquire);
+			return q && q->size() > 0;
+		}
 
+		// true if a view has finished loading a file in the background
+		bool views_loaded() const
+		{
+			for (const Trace_view& v : views) { if (v.loaded()) { return true; } }
+			return false;
+		}
 
-		// scaling behaviour
-		MP_SCALING scaling_ = MP_AUTO_SCALE;
-		Point2d range_min, range_max;
-		Point2d minimum{ -std::numeric_limits<float>::max() , -std::numeric_limits<float>::max() };
-		Point2d maximum{  std::numeric_limits<float>::max() ,  std::numeric_limits<float>::max() };
-		Point2d scale;
-		Point2d offset;
+		// render thread, see render_thread()
+		std::thread renderer;
+		std::mutex frame_mutex;						// held by the render thread while it draws
+		std::atomic<bool> render_running{ false };
+		std::atomic<bool> frame_requested{ false };
+		std::atomic<bool> window_open{ true };
+		std::chrono::duration<double> frame_period{ 1.0 / 60.0 };
 
+		void render_loop()
+		{
+			using namespace std::chrono;
+			#ifndef MULTIPLOT_FLTK
+			make_current();
+			#endif
+			steady_clock::time_point next_frame = steady_clock::now();
+			while (render_running)
+			{
+				{
+					std::lock_guard<std::mutex> lock(frame_mutex);
+					#ifdef MULTIPLOT_FLTK
+					Fl::lock();
+					if (frame_requested.exchange(false) || views_loaded())
+					{
+						if (needs_redraw()) { Fl_Gl_Window::redraw(); } else { skipped_frames_++; }
+					}
+					window_open = check_events();
+					Fl::unlock();
+					#else
+					if (frame_requested.exchange(false) || views_loaded())
+					{
+						if (needs_redraw()) { timed_present([this] { draw(); swap_buffers(); }); } else { skipped_frames_++; }
+					}
+					#endif
+				}
 
-		std::vector< Trace > traces;
+				// frame rate cap. if drawing took longer than a frame, don't try to catch up
+				next_frame += duration_cast<steady_clock::duration>(frame_period);
+				const steady_clock::time_point now = steady_clock::now();
+				if (next_frame < now) { next_frame = now; }
+				std::this_thread::sleep_until(next_frame);
+			}
+			// hand the context back: the caller's thread can only draw if it is not current here
+			#ifdef MULTIPLOT_FLTK
+			Fl::lock();
+			make_current();
+			release_buffers();
+			context(NULL, 1); // destroys the context, a new one is created by the next draw
+			Fl::unlock();
+			#endif
+			#ifndef MULTIPLOT_FLTK
+			release_current();
+			#endif
+		}
 
 		// grid - vars
 		int gridx = MP_NO_GRID;
@@ -1168,6 +6406,61 @@ public:
 		float grid_linewidth = 1.0f;
 		Point2d grid_spacing;
 
+		// text of the frame: the labels of the grid and the hud
+		Text_batch text;
+		Axis_ticks x_ticks, y_ticks;	// grid lines and labels, see draw_grid()
+
+		// the values shown in the caption, it is rebuilt only when one of them changes
+		struct Caption_values
+		{
+			std::wstring title;
+			double values[6];
+			bool grid;
+			bool operator==(const Caption_values& c) const { return title == c.title && grid == c.grid && 0 == memcmp(values, c.values, sizeof(values)); }
+		};
+		Caption_values caption_values{ L"", {}, false };
+		bool caption_valid = false;
+
+		// MP_LOG_GRID makes an axis logarithmic
+		Axis_transform axis_transform() const
+		{
+			return Axis_transform(MP_LOG_GRID == gridx, MP_LOG_GRID == gridy);
+		}
+
+		// the range [lo, hi] of values on a logarithmic axis in axis coordinates. values <= 0 have
+		// no logarithm: if the range contains some, the axis shows 6 decades below the maximum
+		static void log_range(double& lo, double& hi)
+		{
+			const double top = hi > 0.0 ? hi : 1.0;
+			lo = lo > 0.0 ? std::log10(lo) : std::log10(top) - 6.0;
+			hi = std::log10(top);
+		}
+
+		// frees the vertex buffers of all traces on the graphics card
+		void release_buffers()
+		{
+			bool has_buffers = false;
+			for (const Trace& t : traces) { if (t.has_buffers()) { has_buffers = true; } }
+			for (const Trace_view& v : views) { if (v.has_buffers()) { has_buffers = true; } }
+			if (text.has_texture() || frame_cache.has_texture()) { has_buffers = true; }
+			if (!has_buffers) { return; }
+			#ifdef MULTIPLOT_FLTK
+			if (!shown()) // the context and its buffers are already gone
+			{
+				for (Trace& t : traces) { t.release_buffers(false); }
+				for (Trace_view& v : views) { v.release_buffers(false); }
+				text.release(false);
+				frame_cache.release(false);
+				return;
+			}
+			#endif
+			make_current();
+			for (Trace& t : traces) { t.release_buffers(); }
+			for (Trace_view& v : views) { v.release_buffers(); }
+			text.release();
+			frame_cache.release();
+		}
+
 		void initgl()
 		{
 			glViewport(0 , 0,width ,height);	// Set Up A Viewport
@@ -1184,210 +6477,357 @@ public:
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);			// Clear The Screen And Depth Buffer
 		}	
 
+		// draws the grid lines of both axes and adds their labels to the text batch.
+		// the ticks are only recomputed when the visible range changes, see Axis_ticks.
+		// returns the spacing of the major grid lines in axis coordinates
 		Point2d draw_grid()
 		{
-			double xstep=0;
-			double ystep=0;
-			if(gridx==MP_LINEAR_GRID)
+			// the visible range. at most one line per 8 pixels
+			x_ticks.update(gridx, offset.x, offset.x + width / scale.x, gridx_step, width / 8);
+			y_ticks.update(gridy, offset.y, offset.y + height / scale.y, gridy_step, height / 8);
+			const Point2d spacing(float(x_ticks.step), float(y_ticks.step));
+			if (x_ticks.ticks.empty() && y_ticks.ticks.empty()) { return spacing; }
+
+			// minor ticks (of a logarithmic axis) in a color between grid and background
+			const Color3f minor_col(0.5f * (grid_col.r + bg_col.r), 0.5f * (grid_col.g + bg_col.g), 0.5f * (grid_col.b + bg_col.b));
+			glLineWidth(grid_linewidth);
+			glBegin(GL_LINES);
+			for (const Axis_ticks::Tick& t : x_ticks.ticks)
 			{
-				double diff=maximum.x - minimum.x;
-				if(diff==0)return Point2d(0,0);
-				double exp=floor(log10(fabs(diff)));
-				double shiftscale=pow(10.0,exp);
-				// get the starting point for the grid
-				double startx=shiftscale*floor(minimum.x / shiftscale);
-
-				if(gridx_step>0)
-				{
-					xstep=gridx_step;
-				}
-				else	// auto grid size
-				{			
-					xstep=shiftscale*1.0;
-					if(diff/xstep < 4) // draw more lines
-						xstep*=0.5;
-
-					/*
-					xstep=floor(maximum.x / shiftscale) - floor(minimum.x / shiftscale);
-					xstep=2*floor(0.5*xstep);// if uneven, make even, because uneven stepsizes will cause uneven distributed lines around the (0,0) koordinate frame axis
-					xstep=shiftscale*xstep / 4.0;
-					*/
-
-				}
-				double x=startx;
-
-				glLineWidth(grid_linewidth);
-				glColor3f(grid_col.r, grid_col.g, grid_col.b);
-				glBegin(GL_LINES);
-				int bailout=0; // bailout is a safety to avoid endless recursions caused maybe through numerical errors..
-				while(x<maximum.x && bailout<100)
-				{
-					x+=xstep;
-					bailout++;
-					glVertex2f((GLfloat)(x-offset.x)*scale.x	,0.0f  );
-					glVertex2f((GLfloat)(x-offset.x)*scale.x	,(float)height);
-				}
-				glEnd();
+				const Color3f& c = t.major ? grid_col : minor_col;
+				const float x = float((t.pos - offset.x) * scale.x);
+				glColor3f(c.r, c.g, c.b);
+				glVertex2f(x, 0.0f);
+				glVertex2f(x, float(height));
 			}
-			if(gridy==MP_LINEAR_GRID)
+			for (const Axis_ticks::Tick& t : y_ticks.ticks)
 			{
-				double diff=maximum.y - minimum.y;
-				if(diff==0)return Point2d(0,0);
-				double exp=floor(log10(fabs(diff)));
-				double shiftscale=pow(10.0,exp);
-				// get the starting point for the grid
-				double starty=shiftscale*floor(minimum.y / shiftscale);
-
-				if(gridy_step>0)
-				{
-					ystep=gridy_step;
-				}
-				else	// auto grid size
-				{
-					ystep=shiftscale*1.0;
-					if(diff/ystep < 4) // draw more lines
-						ystep*=0.5;
-
-					/*
-					ystep=floor(maximum.y / shiftscale) - floor(minimum.y / shiftscale);
-					ystep=2*floor(0.5*ystep); // if uneven, make even, because uneven stepsizes will cause uneven distributed lines around the (0,0) koordinate frame axis
-					ystep=shiftscale*ystep / 4.0;
-					*/
-
-				}
-				double y=starty;
-				glLineWidth(1.0);
-				glColor3f(grid_col.r, grid_col.g, grid_col.b);
-				glBegin(GL_LINES);
-				int bailout=0; // bailout is a safety to avoid endless recursions caused maybe through numerical errors..
-				while(y<maximum.y && bailout<100)
-				{
-					y+=ystep;
-					bailout++;
-					glVertex2f(0.0f					,(GLfloat)(y-offset.y)*scale.y);
-					glVertex2f((float)width			,(GLfloat)(y-offset.y)*scale.y);
-				}
-				glEnd();
-
-				#ifdef MULTIPLOT_FLTK // gl_font is only available with fltk...
-                //********************************************************************
-                // I don't know why I can't just stick the below
-                // glRasterPos2f() && gl_draw() calls in the above loop, but
-                // It doesn't work if I do.  Must be due to the glBegin() thingy?
-                // So, I'm left to do the above loop again (for now)!
-                // This hack also has the undesireable side effect of putting
-                // The Axis Label in the Plot area itself, not in a margin.
-                //********************************************************************
-                gl_font(1, 10);
-                y=starty;
-                bailout=0;
-				
-				std::string s;
-				std::stringstream ss;
-                while(y<maximum.y && bailout<100)
-                {
-					float y_pos = (y - offset.y) * scale.y + 1;
-					if (y_pos >= 0.0 && y_pos < h())
-					{
-						//s = std::to_string(y); // stringstream produces better floating point number formatting out of the box
-						ss << y;
-						s = ss.str();
-						glRasterPos2f(0.5f, (GLfloat)y_pos);
-						gl_draw(s.c_str(), int(s.length()));
-						ss.str("");
-					}
-					y += ystep;
-					bailout++;
-				}
-                //********************************************************************
-				#endif
+				const Color3f& c = t.major ? grid_col : minor_col;
+				const float y = float((t.pos - offset.y) * scale.y);
+				glColor3f(c.r, c.g, c.b);
+				glVertex2f(0.0f, y);
+				glVertex2f(float(width), y);
 			}
-
-			return Point2d((float)xstep,(float)ystep);
+			glEnd();
+			count_state(2);
+			count_draw(2 * (x_ticks.ticks.size() + y_ticks.ticks.size()));
+
+			// the labels next to the lines. labels that would overlap the previous one are left out,
+			// and the y labels leave the bottom row to the x labels
+			const float row = float(Text_batch::glyph_h + 2);
+			float free_x = 0.0f;
+			for (const Axis_ticks::Tick& t : x_ticks.ticks)
+			{
+				const float x = float((t.pos - offset.x) * scale.x) + 2.0f;
+				if (t.label.empty() || x < free_x || x >= width) { continue; }
+				text.add(x, 2.0f, t.label, grid_col.r, grid_col.g, grid_col.b);
+				free_x = x + Text_batch::width(t.label) + 4.0f;
+			}
+			float free_y = free_x > 0.0f ? row : 0.0f;
+			for (const Axis_ticks::Tick& t : y_ticks.ticks)
+			{
+				const float y = float((t.pos - offset.y) * scale.y) + 1.0f;
+				if (t.label.empty() || y < free_y || y >= height) { continue; }
+				text.add(1.0f, y, t.label, grid_col.r, grid_col.g, grid_col.b);
+				free_y = y + row;
+			}
+			return spacing;
 		}
 
 		virtual void draw() //override
 		{
 			using namespace std;
 
+			// the metrics of this frame: lap() returns the time since its last call
+			const bool timed = metrics_frames > 0;
+			const chrono::steady_clock::time_point frame_start = chrono::steady_clock::now();
+			chrono::steady_clock::time_point lap_start = frame_start;
+			auto lap = [&]() -> double
+			{
+				if (!timed) { return 0.0; }
+				const chrono::steady_clock::time_point t = chrono::steady_clock::now();
+				const double ms = chrono::duration<double, milli>(t - lap_start).count();
+				lap_start = t;
+				return ms;
+			};
+			Frame_metrics this_frame;
+			counters() = Draw_counters();
+
 			if(!valid() )
 			{
 				width=w();
 				height=h();
 				initgl();
 				valid(true);
+				frame_cache.invalidate();
 			}
 
 			Multiplot_base::draw();
 
-			glClear(GL_COLOR_BUFFER_BIT);// | GL_DEPTH_BUFFER_BIT);			// Clear The Screen And Depth Buffer
-
+			// take over the samples of other threads
+			drain();
+			this_frame.ingest_ms = lap();
 
-			// draw the grid
-			grid_spacing=draw_grid();
-
-			// draw the coordinate cross with center (0,0)
-			glLineWidth(2.0f*grid_linewidth);
-			glColor3f(grid_col.r, grid_col.g, grid_col.b);
-			glBegin(GL_LINES);
-			glVertex2f(0.0f					,0-offset.y*scale.y);
-			glVertex2f((float)width			,0-offset.y*scale.y);
-			glVertex2f(0-offset.x*scale.x	,0.0f  );
-			glVertex2f(0-offset.x*scale.x	,(float)height);		
-			glEnd();
+			glClear(GL_COLOR_BUFFER_BIT);// | GL_DEPTH_BUFFER_BIT);			// Clear The Screen And Depth Buffer
 
 
-			
-			maximum.x=maximum.y= -std::numeric_limits<float>::max();
-			minimum.x=minimum.y=  std::numeric_limits<float>::max();
+			// get the bounding box of all traces
+			maximum.x=maximum.y= -std::numeric_limits<double>::max();
+			minimum.x=minimum.y=  std::numeric_limits<double>::max();
 
 			for(size_t t=0;t<traces.size();t++)
 			{
-				traces[t].draw(minimum, maximum, scale, offset);
+				traces[t].extend_bounds(minimum, maximum);
 			}
-
-				
-
-			// do the (auto-) scaling
-			offset.x=minimum.x;
-			offset.y=minimum.y;
-			float diff_x = maximum.x-minimum.x;
-			float diff_y = maximum.y-minimum.y;
+			for (Trace_view& v : views) { v.extend_bounds(minimum, maximum); }
+
+
+			// do the (auto-) scaling. scale and offset map axis coordinates to the window
+			const Axis_transform axes = axis_transform();
+			Vec2d lo = (MP_FIXED_SCALE == scaling_) ? range_min : minimum;
+			Vec2d hi = (MP_FIXED_SCALE == scaling_) ? range_max : maximum;
+			if (axes.log_x) { log_range(lo.x, hi.x); }
+			if (axes.log_y) { log_range(lo.y, hi.y); }
+			offset.x=lo.x;
+			offset.y=lo.y;
+			double diff_x = hi.x-lo.x;
+			double diff_y = hi.y-lo.y;
 			switch(scaling_)
 			{
 			case MP_AUTO_SCALE:
-				if (diff_x != 0.0) { scale.x = width / diff_x; }
-				if (diff_y != 0.0) { scale.y = height / diff_y; }
+				if (diff_x != 0.0) { scale.x = float(width / diff_x); }
+				if (diff_y != 0.0) { scale.y = float(height / diff_y); }
 				break;
 			case MP_AUTO_SCALE_EQUAL:
 				
 				if(std::max(diff_x, diff_y) != 0)
 				{
-					scale.x=scale.y=std::min(width, height) / std::max(diff_x, diff_y);
+					scale.x=scale.y=float(std::min(width, height) / std::max(diff_x, diff_y));
 					//scale.y=height/diff;
 				}
 				break;
 			case MP_FIXED_SCALE:
-				scale.x = width /(range_max.x - range_min.x);
-				scale.y = height/(range_max.y - range_min.y);
-				offset.x = range_min.x;
-				offset.y = range_min.y;
+				scale.x = float(width / diff_x);
+				scale.y = float(height / diff_y);
 				break;
 			}
 
 
-			// possible performance issue?
-			caption_str  = title_str + L" ";
-			caption_str += L"x=[" + to_wstring(minimum.x) + L", " + to_wstring(maximum.x) + L"] ";
-			caption_str += L"y=[" + to_wstring(minimum.y) + L", " + to_wstring(maximum.y) + L"] ";
-			if(gridx != MP_NO_GRID || gridy != MP_NO_GRID)
+			this_frame.bounds_ms = lap();
+
+			// while the mouse zooms or moves the view, a slow frame is replaced by the last one,
+			// stretched to the new view
+			const bool preview = nav.active && frame_cache.valid(width, height);
+			if (preview)
+			{
+				frame_cache.draw(float((nav.frame_lo.x - offset.x) * scale.x), float((nav.frame_lo.y - offset.y) * scale.y),
+					float((nav.frame_hi.x - offset.x) * scale.x), float((nav.frame_hi.y - offset.y) * scale.y));
+				count_draw(4);
+			}
+			else
+			{
+				// draw the grid
+				grid_spacing=draw_grid();
+
+				// draw the coordinate cross with center (0,0). a logarithmic axis has no 0
+				glLineWidth(2.0f*grid_linewidth);
+				glColor3f(grid_col.r, grid_col.g, grid_col.b);
+				glBegin(GL_LINES);
+				if (!axes.log_y)
+				{
+					glVertex2f(0.0f					,float(0-offset.y*scale.y));
+					glVertex2f((float)width			,float(0-offset.y*scale.y));
+				}
+				if (!axes.log_x)
+				{
+					glVertex2f(float(0-offset.x*scale.x)	,0.0f  );
+					glVertex2f(float(0-offset.x*scale.x)	,(float)height);
+				}
+				glEnd();
+				count_state(2);
+				count_draw(axes.linear() ? 4 : axes.log_x && axes.log_y ? 0 : 2);
+				this_frame.grid_ms = lap();
+
+
+				// draw the traces. their points stay in data coordinates,
+				// scale and offset are applied by the modelview matrix,
+				// so changes of the scaling never touch the point data.
+				// each trace adds the translation from its base to the offset.
+				glMatrixMode(GL_MODELVIEW);
+				glPushMatrix();
+				glScalef(scale.x, scale.y, 1.0f);
+				for(size_t t=0;t<traces.size();t++)
+				{
+					traces[t].draw(scale, offset, axes, width, height);
+					if (timed) { this_frame.trace_ms.push_back(lap()); }
+				}
+				for (Trace_view& v : views)
+				{
+					v.draw(scale, offset, axes);
+					if (timed) { this_frame.view_ms.push_back(lap()); }
+				}
+				glPopMatrix();
+			}
+
+			if (hud_ && !preview)
+			{
+				draw_hud();
+				lap(); // not part of any phase
+			}
+
+			// labels and hud text, all in one draw call
+			if (text.size())
+			{
+				count_draw(4 * text.size());
+				text.draw();
+			}
+
+			// a slow frame is kept for the next mouse movement
+			if (!preview)
+			{
+				if (nav.on && ms_since(frame_start) > nav.preview_ms)
+				{
+					frame_cache.capture(width, height);
+					nav.frame_lo = offset;
+					nav.frame_hi = Vec2d(offset.x + width / scale.x, offset.y + height / scale.y);
+				}
+				else { frame_cache.invalidate(); }
+			}
+			if (DRAG_BOX == nav.drag) { draw_box(); }
+
+
+			// the caption only changes with the range or the grid spacing
+			const bool grid = gridx != MP_NO_GRID || gridy != MP_NO_GRID;
+			const Caption_values now{ title_str, { minimum.x, minimum.y, maximum.x, maximum.y, grid_spacing.x, grid_spacing.y }, grid };
+			if (!caption_valid || !(now == caption_values))
 			{
-				caption_str += L"dx=[" + to_wstring(grid_spacing.x) + L"] ";
-				caption_str += L"dy=[" + to_wstring(grid_spacing.y) + L"] ";
+				caption_values = now;
+				caption_valid = true;
+				caption_str  = title_str + L" ";
+				caption_str += L"x=[" + to_wstring(minimum.x) + L", " + to_wstring(maximum.x) + L"] ";
+				caption_str += L"y=[" + to_wstring(minimum.y) + L", " + to_wstring(maximum.y) + L"] ";
+				if(grid)
+				{
+					caption_str += L"dx=[" + to_wstring(grid_spacing.x) + L"] ";
+					caption_str += L"dy=[" + to_wstring(grid_spacing.y) + L"] ";
+				}
+				caption(caption_str.c_str() );
+			}
+
+			if (timed)
+			{
+				this_frame.caption_ms = lap();
+				this_frame.frame = metrics_count++;
+				this_frame.start_us = chrono::duration<double, micro>(frame_start - metrics_epoch).count();
+				this_frame.total_ms = chrono::duration<double, milli>(lap_start - frame_start).count();
+				this_frame.events_ms = metrics_events_ms;
+				metrics_events_ms = 0;
+				this_frame.vertices = counters().vertices;
+				this_frame.draw_calls = counters().draw_calls;
+				this_frame.state_changes = counters().state_changes;
+				for (const Trace& t : traces) { this_frame.points += t.size(); }
+				for (const Trace_view& v : views) { this_frame.points += v.size(); }
+				const size_t plotted_ = plotted();
+				this_frame.points_ingested = plotted_ - metrics_plotted;
+				metrics_plotted = plotted_;
+				metrics_history.push_back(std::move(this_frame));
+				while (metrics_history.size() > metrics_frames) { metrics_history.pop_front(); }
+			}
+
+			frame_ms = ms_since(frame_start);
+			dirty = 0;
+			for (Trace& t : traces) { t.changed = false; }
+			for (Trace_view& v : views) { v.changed = false; }
+		}
+};
+
+/**
+*	Window_manager handles the events and frames of all multiplot windows of the process in
+*	one pass, instead of a check() and a redraw() for every window:
+*
+*		Window_manager& windows = Window_manager::instance();
+*		while (windows.check()) { m1.plot(x, y1); m2.plot(x, y2); ... }
+*
+*	check() handles the events of all windows once, then draws every window that has changed
+*	since its last frame (and whose frame_rate_limit() allows a frame). with frame_budget(ms),
+*	a pass only draws windows until their frames add up to ms milliseconds; the windows that
+*	have waited the longest go first, so every window gets its turn. windows with a
+*	render_thread() draw themselves and are left out.
+*	the gl contexts of all windows share their objects, so the font texture exists only once.
+*	create the windows and call check() in the same thread.
+*/
+class Window_manager
+{
+public:
+	static Window_manager& instance() { static Window_manager w; return w; }
+
+	/**
+	*	handles the events of all windows and draws the windows that need a frame.
+	*	returns false when all windows have been closed.
+	*/
+	bool check()
+	{
+		#ifdef MULTIPLOT_FLTK
+		schedule();
+		Multiplot_base::handle_events(); // draws the scheduled windows as well
+		#else
+		{
+			// windows with a render thread handle their events under their frame lock
+			std::vector< std::unique_lock<std::mutex> > locks;
+			for (Multiplot* m : Multiplot::windows())
+			{
+				if (m->render_running) { locks.push_back(std::unique_lock<std::mutex>(m->frame_mutex)); }
 			}
-			
-			caption(caption_str.c_str() );
+			Multiplot_base::handle_events();
+		}
+		schedule();
+		#endif
+		for (Multiplot* m : Multiplot::windows()) { if (m->is_open()) { return true; } }
+		return false;
+	}
+
+	/**
+	*	the time in milliseconds a check() may spend on drawing, 0 (the default) draws
+	*	every window that needs a frame. the cost of a frame is estimated by the last
+	*	frame of its window, a pass always draws at least one.
+	*/
+	void frame_budget(double ms) { budget_ms = ms; }
+
+	/** the number of windows */
+	size_t windows() const { return Multiplot::windows().size(); }
+
+	/** the number of frames drawn by the last check() */
+	size_t drawn() const { return drawn_; }
+
+protected:
+	double budget_ms = 0.0;
+	size_t drawn_ = 0;
+	std::vector<Multiplot*> due;
+
+	Window_manager() {}
+
+	// draws the windows that need a frame, those that have waited the longest first
+	void schedule()
+	{
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		due.clear();
+		for (Multiplot* m : Multiplot::windows())
+		{
+			if (m->render_running || !m->is_open() || now - m->last_frame < m->min_frame_interval) { continue; }
+			if (m->needs_redraw()) { due.push_back(m); }
+		}
+		std::stable_sort(due.begin(), due.end(), [](const Multiplot* a, const Multiplot* b) { return a->last_frame < b->last_frame; });
+
+		double spent = 0.0;
+		drawn_ = 0;
+		for (Multiplot* m : due)
+		{
+			if (budget_ms > 0.0 && drawn_ > 0 && spent + m->frame_ms > budget_ms) { continue; }
+			m->draw_frame();
+			spent += m->frame_ms;
+			drawn_++;
 		}
+	}
 };
 
 } // end namespace
@@ -1520,7 +6960,7 @@ void demo3()
 {
 	Multiplot m(10,10,600,600);
 
-	m.grid(MP_LINEAR_GRID, MP_LOG_GRID);
+	m.grid(MP_LINEAR_GRID, MP_LINEAR_GRID);
 
 	m.scrolling(MP_SCROLL_LEFT, 100);		// the last  50 added points of the plot will be drawn 
 	m.linewidth(2);	// first trace has line-width of 2	
@@ -1666,11 +7106,6 @@ void demo8()
 
 void demo9()
 {
-	#ifndef MULTIPLOT_FLTK
-	cerr << "More than one Multiplot window is currently only supported with FLTK as a backend.\n";
-	return;
-	#endif
-
 	Multiplot m1(20,  20, 600, 300);
 	Multiplot m2(20, 380, 600, 300);
 	
@@ -1680,20 +7115,18 @@ void demo9()
 	m1.show();
 	m2.show();
 
+	// one check() handles the events of both windows and draws the ones that have changed
+	Window_manager& windows = Window_manager::instance();
 	for (int x = 0; x < 300; x++)
 	{
 		m1.plot(float(x), 0.1f*x*sin(0.1f*x));
 		m2.plot(float(x), 0.1f*x*cos(0.1f*x));
-		m1.redraw();
-		m2.redraw();
-		if (!m1.check()) { break; }
+		if (!windows.check()) { break; }
 		m1.sleep(20);
 	}
 
-	while (m1.check() || m2.check())
+	while (windows.check())
 	{
-		m1.redraw();
-		m2.redraw();
 		m1.sleep(100);
 	}
 }
@@ -1732,6 +7165,49 @@ void demo10()
 }
 
 
+// demo11 shows logarithmic axes: the frequency response of a resonant low pass filter
+void demo11()
+{
+	Multiplot m(10, 10, 800, 600);
+	m.grid(MP_LOG_GRID, MP_LOG_GRID);
+
+	for (int i = 0; i <= 500; i++)
+	{
+		float f = pow(10.0f, 5.0f * i / 500.0f);	// 1 Hz .. 100 kHz
+		float w = f / 1000.0f;
+		m.plot(f, 1.0f / sqrt((1 - w*w)*(1 - w*w) + 0.04f*w*w));
+		m.redraw();
+		if (!m.check()) { break; }
+		m.sleep(5);
+	}
+	keep_alive(m);
+}
+
+// demo12: a scatter plot with millions of points, drawn as a density map
+void demo12()
+{
+	Multiplot m(10, 10, 800, 600);
+	m.color3f(1.0f, 0.5f, 0.1f);
+	m.density();
+
+	std::vector<float> x(50000), y(50000);
+	for (int k = 0; k < 100; k++)
+	{
+		// two gauss - distributions, the second one moves slowly
+		for (size_t i = 0; i < x.size(); i++)
+		{
+			float a = -1 + 2.0f*rand()/RAND_MAX, b = -1 + 2.0f*rand()/RAND_MAX;
+			float r = sqrt(-2 * log(1e-9f + 1.0f*rand()/RAND_MAX));
+			if (i % 3) { x[i] = r * a; y[i] = r * b; }
+			else { x[i] = 3 + 0.5f*r*a + 0.02f*k; y[i] = 2 + 0.5f*r*b; }
+		}
+		m.plot(x.data(), y.data(), x.size());
+		m.redraw();
+		if (!m.check()) { break; }
+		m.sleep(20);
+	}
+	keep_alive(m);
+}
 
 
 void test_module()
@@ -1751,8 +7227,10 @@ menu:
 	std::cout << "\n(8) demo: no auto-scaling, set fixed scaling of both x and y axis.";
 	std::cout << "\n(9) demo: using two or more Multiplot windows simulataneously.";
 	std::cout << "\n(10) demo: Oscilloscope like scrolling (trace jumps / warps around to the beginning of the plot)";
+	std::cout << "\n(11) demo: logarithmic axes (frequency response of a filter)";
+	std::cout << "\n(12) demo: density map of a scatter plot with 5 million points";
 	std::cout << "\n(0) exit.";
-	std::cout << "\nenter number of demo (1..10):";
+	std::cout << "\nenter number of demo (1..12):";
 	std::cin >> demo_number;
 	switch (demo_number)
 	{
@@ -1766,6 +7244,8 @@ menu:
 	case 8:demo8(); break;
 	case 9:demo9(); break;
 	case 10:demo10(); break;
+	case 11:demo11(); break;
+	case 12:demo12(); break;
 	case 0:return;  break;
 	default:demo1(); break;
 	}